@@ -0,0 +1,77 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+
+/* PACKED ASSET ARCHIVE (.pak) :
+ All files of the assets/ tree in one file, opened once and memory-mapped read-only.
+ Layout (little endian):
+   ArchiveHeader                      magic "SGPK", version, entry count, offset of the string table
+   ArchiveEntry[entryCount]           sorted by path hash, so lookups are a binary search
+   string table                       the asset paths, e.g. "assets/sounds/click.wav"
+   file data                          every file starts on an ARCHIVE_ALIGNMENT boundary
+ Lookups return pointers straight into the mapping; decoders read from there without a copy.
+ This file does not include raylib, so the OS mapping headers (windows.h) cannot clash with it.*/
+
+const unsigned int ARCHIVE_MAGIC = 0x4B504753;   // "SGPK"
+const unsigned int ARCHIVE_VERSION = 1;
+const unsigned int ARCHIVE_ALIGNMENT = 64;
+
+struct ArchiveHeader {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int entryCount;
+    unsigned int stringTableOffset;
+};
+
+struct ArchiveEntry {
+    unsigned long long pathHash;
+    unsigned int pathOffset;      // Into the string table.
+    unsigned int pathLength;
+    unsigned long long dataOffset; // From the start of the archive.
+    unsigned long long dataSize;
+};
+
+// A read-only view of a whole file. Unmapped on Close() or destruction.
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const char* path);
+    void Close();
+    const unsigned char* Data() const { return data; }
+    size_t Size() const { return size; }
+    bool IsOpen() const { return data != nullptr; }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+class AssetArchive {
+public:
+    bool Open(const char* path);
+    void Close();
+    bool IsOpen() const { return file.IsOpen(); }
+
+    // Pointer into the mapping and size of an asset, or nullptr if the archive does not contain it.
+    const unsigned char* Find(const char* path, int* size) const;
+    int GetEntryCount() const { return header ? (int)header->entryCount : 0; }
+
+    static unsigned long long HashPath(const char* path);
+
+    // Builds an archive from a list of (archive path, file on disk) pairs. Used by tools/pack_assets.cpp.
+    static bool Write(const char* outPath, const std::vector<std::string>& archivePaths, const std::vector<std::string>& diskPaths);
+
+private:
+    MappedFile file;
+    const ArchiveHeader* header = nullptr;
+    const ArchiveEntry* entries = nullptr;
+    const char* strings = nullptr;
+};
@@ -0,0 +1,71 @@
+﻿#pragma once
+#include "raylib.h"
+#include "AssetArchive.h"
+#include "TextureCache.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class AssetKind { TEXTURE, SOUND, MUSIC };
+
+/* ASYNCHRONOUS ASSET LOADER :
+ File reading and decoding (PNG -> Image, WAV/MP3 -> Wave, music file bytes) runs on worker threads,
+ because those raylib functions only touch CPU memory. Everything that needs the GPU or the audio
+ device (LoadTextureFromImage, LoadSoundFromWave, opening the music stream) stays on the main thread
+ and happens in UploadPending(), which the loading screen calls once per frame with a time budget.*/
+class AssetLoader {
+public:
+    ~AssetLoader();
+
+    // Queue requests before Start(). 'target' must stay valid until the job is uploaded.
+    void QueueTexture(Texture2D* target, const char* path);
+    void QueueSound(const char* name, const char* path);
+    void QueueMusic(const char* name, const char* path);
+
+    // Optional packed archive. Assets found in it are decoded straight from the mapped bytes, others from disk.
+    void SetArchive(const AssetArchive* pak) { archive = pak; }
+    // Optional decoded-texture cache. Textures found in it skip decoding entirely.
+    void SetTextureCache(TextureCache* cache) { textureCache = cache; }
+
+    void Start(int workerCount = 0);
+    // Main thread: turns decoded jobs into GPU textures / audio objects until 'budgetMs' is used up.
+    int UploadPending(double budgetMs);
+    void Finish();
+
+    bool IsDone() const { return uploaded == (int)jobs.size(); }
+    int GetTotal() const { return (int)jobs.size(); }
+    int GetUploaded() const { return uploaded; }
+    // Decoded counts as half the work, upload as the other half.
+    float GetProgress() const;
+    double GetDecodeMs() const { return decodeMs.load() / 1000.0; }
+
+private:
+    struct Job {
+        AssetKind kind;
+        std::string name;
+        std::string path;
+        Texture2D* target;
+        CachedImage image;
+        Wave wave;
+        unsigned char* fileData;
+        int fileSize;
+        bool fileDataMapped;    // fileData points into the archive mapping and must not be freed.
+    };
+
+    void WorkerMain();
+    void Decode(Job& job);
+    void Upload(Job& job);
+
+    const AssetArchive* archive = nullptr;
+    TextureCache* textureCache = nullptr;
+    std::vector<Job> jobs;
+    std::vector<std::thread> workers;
+    std::atomic<int> nextJob{ 0 };
+    std::atomic<int> decoded{ 0 };
+    std::atomic<long long> decodeMs{ 0 };   // Summed worker time, in microseconds.
+    std::mutex readyMutex;
+    std::vector<int> ready;                 // Decoded jobs waiting for upload.
+    int uploaded = 0;
+};
@@ -0,0 +1,100 @@
+﻿#pragma once
+#include "raylib.h"
+#include "AssetArchive.h"
+#include "TextureCache.h"
+#include <deque>
+#include <string>
+
+// What an asset is used for. Memory is reported per class.
+enum class AssetClass { UI, ENEMY, TOWER, PROJECTILE, EFFECT, ENVIRONMENT, SOUND, MUSIC, COUNT };
+
+// Weak reference to a registered texture. Cheap to copy; does not keep the texture resident.
+struct TextureHandle {
+    unsigned int index = 0;
+    unsigned int generation = 0;    // 0 = invalid. Bumped when the registry is cleared, so old handles stop resolving.
+    bool IsValid() const { return generation != 0; }
+};
+
+/* ASSET REGISTRY :
+ Owns every texture the game registers at startup, and unloads all of them in one place at exit.
+ Anything that keeps a texture for its lifetime (enemies, towers, projectiles, riders) holds a
+ TextureRef, which counts as a reference. Textures with no references (menu and end screen art,
+ map decoration) may be evicted least-recently-used first when the VRAM budget is exceeded; the next
+ Get() loads them again synchronously. Sound and music memory is owned by Audio and only reported.*/
+class AssetRegistry {
+public:
+    // Registering the same path twice returns the same handle.
+    static TextureHandle RegisterTexture(const char* path, AssetClass cls);
+    // Where a loader writes the uploaded texture. Stays valid until Clear().
+    static Texture2D* GetLoadTarget(TextureHandle handle);
+
+    // Returns the texture, reloading it if it was evicted, and marks it used this frame.
+    static const Texture2D& Get(TextureHandle handle);
+
+    static void AddRef(TextureHandle handle);
+    static void Release(TextureHandle handle);
+    static int GetRefCount(TextureHandle handle);
+
+    // Where evicted textures are reloaded from; both optional.
+    static void SetSources(const AssetArchive* pak, TextureCache* cache);
+    // 0 means unlimited. Exceeding the RAM budget is only logged, Audio data cannot be dropped behind its back.
+    static void SetBudget(size_t vramBytes, size_t ramBytes);
+
+    // Once per frame, after EndDrawing(): no draw call of the finished frame can reference an evicted texture.
+    static void Update();
+
+    static size_t GetBytes(AssetClass cls);
+    static size_t GetVramBytes();
+    static int GetEvictions() { return evictions; }
+    static int GetReloads() { return reloads; }
+    static void LogReport();
+
+    // Unloads every registered texture and invalidates all handles.
+    static void Clear();
+
+private:
+    struct Slot {
+        std::string path;
+        AssetClass cls;
+        Texture2D texture;
+        int refCount;
+        unsigned long long lastUsedFrame;
+        bool evicted;       // Unloaded by the budget, as opposed to never loaded (missing file).
+    };
+
+    static Slot* Resolve(TextureHandle handle);
+    static void Reload(Slot& slot);
+
+    static std::deque<Slot> slots;       // deque: load targets keep their address while registering.
+    static unsigned int generation;
+    static unsigned long long frame;
+    static size_t vramBudget;
+    static size_t ramBudget;
+    static bool ramWarned;
+    static int evictions;
+    static int reloads;
+    static const AssetArchive* archive;
+    static TextureCache* textureCache;
+};
+
+// Strong reference: keeps the texture registered as in use for as long as the object holding it lives.
+class TextureRef {
+public:
+    TextureRef() {}
+    TextureRef(TextureHandle h) : handle(h) { AssetRegistry::AddRef(handle); }
+    TextureRef(const TextureRef& other) : handle(other.handle) { AssetRegistry::AddRef(handle); }
+    // noexcept, so vectors of entities move their refs when they grow instead of copying them.
+    TextureRef(TextureRef&& other) noexcept : handle(other.handle) { other.handle = TextureHandle(); }
+    ~TextureRef() { AssetRegistry::Release(handle); }
+
+    TextureRef& operator=(TextureRef other) {
+        TextureHandle tmp = handle; handle = other.handle; other.handle = tmp;
+        return *this;
+    }
+
+    const Texture2D& Get() const { return AssetRegistry::Get(handle); }
+    TextureHandle Handle() const { return handle; }
+
+private:
+    TextureHandle handle;
+};
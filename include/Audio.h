@@ -1,30 +1,196 @@
 ﻿#pragma once
 #include "raylib.h"
-#include <map>
+#include "SpscRing.h"
+#include <atomic>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
+/* SOUND AND MUSIC IDS :
+ Every sound the game code plays is listed here. Audio::Init() interns the names in SFX_NAMES /
+ MUSIC_NAMES (Audio.cpp) in this order, so an enum value is directly the index into the sound
+ table and playing a sound is an array access. Names are only resolved when assets are loaded,
+ and by the string overloads, which are kept as a slow path for debugging and data-driven use.*/
+enum class SoundId {
+    ARROW_SHOOT, ICE_SHOOT, ARROW_HIT, ICE_HIT, MAGIC_SHOOT, SWORD_HIT, ORC_DEATH, BUILD_TOWER,
+    UI_CLICK, GOLD_GAIN, SPAWN_1, SPAWN_2, SPAWN_3, GANDALF, ROHIRRIM, VICTORY, ORC_WALK, HEAVY_WALK,
+    COUNT
+};
+
+enum class MusicId { MENU, LEVEL1, LEVEL2, LEVEL3, BOSS, GAME_OVER, VICTORY_JINGLE, COUNT };
+
+// Default length of the crossfade when one track replaces another, and of the fade-out on StopMusic().
+const float MUSIC_CROSSFADE_SECONDS = 1.5f;
+const float MUSIC_STOP_FADE_SECONDS = 0.3f;
+
+// Counters of the SFX voice pool since the last ResetStats().
+struct AudioStats {
+    int requests;       // PlaySFX() calls.
+    int coalesced;      // Requests merged into another request for the same sound in the same frame.
+    int started;        // Voices actually started.
+    int stolen;         // Playing voices of other sounds cut off to make room in the pool.
+    int restarted;      // Voices of a sound at its own cap restarted for a new request of that sound.
+    int dropped;        // Requests with no voice available at their priority.
+    int culled;         // Positional requests too far from the listener to be heard.
+    int overBudget;     // Requests cut by the per-frame sound budget.
+};
+
+/* AUDIO THREAD :
+ Audio runs on its own thread. The public functions below are called from the game thread and only
+ push commands into a lock-free single-producer ring (SpscRing.h); they never touch the audio device
+ and never wait for it. The audio thread owns the sound and music tables: it applies the commands,
+ allocates voices and keeps the music stream filled every couple of milliseconds, so a long game frame
+ cannot starve the music buffer. Queries (stats, memory) read counters the audio thread publishes.*/
 class Audio {
 public:
     static void Init();
     static void Close();
+    // Once per game frame: hands this frame's sound effect requests to the audio thread.
     static void Update();
 
     // It loads sound effects and music into memory by naming them.
-    static void LoadSFX(std::string name, const char* path);
-    static void LoadMusic(std::string name, const char* path);
+    static void LoadSFX(const std::string& name, const char* path);
+    static void LoadMusic(const std::string& name, const char* path);
+
+    // Variants for data that was already decoded/read on a loader thread. Audio takes ownership of the wave,
+    // and with 'takeOwnership' of the music data too (freed when the track is unloaded).
+    static void LoadSFXFromWave(const std::string& name, Wave wave);
+    static void LoadMusicFromMemory(const std::string& name, const char* fileType, unsigned char* data, int dataSize, bool takeOwnership = true);
+
+    // Name -> id. Names that are not in the enums get ids past COUNT the first time they are seen.
+    static int InternSound(const std::string& name);
+    static int InternMusic(const std::string& name);
 
     // Plays a sound effect. By changing the pitch, the same sound can be produced in different tones.
-    static void PlaySFX(std::string name, float volume = 1.0f, float pitch = 1.0f);
+    // Requests are collected and sent to the audio thread by the next Update(), see the voice pool in Audio.cpp.
+    static void PlaySFX(SoundId id, float volume = 1.0f, float pitch = 1.0f) { PlaySFXIndex((int)id, volume, pitch); }
+    static void PlaySFX(const std::string& name, float volume = 1.0f, float pitch = 1.0f);
+    // A sound that happens somewhere on the map: attenuated and panned by its distance to the listener,
+    // and not played at all when it is out of earshot. UI and global events keep using PlaySFX().
+    static void PlaySFXAt(SoundId id, Vector2 worldPos, float volume = 1.0f, float pitch = 1.0f);
+
+    // Where the player "hears" from (the center of the camera view), and the distance up to which
+    // positional sounds play at full volume. They fade out over the same distance again.
+    static void SetListener(Vector2 center, float hearingRadius);
+    // At most this many different sounds are started per frame; the least important ones are cut.
+    static void SetSFXBudget(int maxPerFrame);
+
+    // How many copies of a sound may overlap, and how important it is when voices run out (higher wins).
+    static void SetSFXLimits(SoundId id, int maxVoices, int priority);
 
-    static void PlayMusic(std::string name);
-    static void StopMusic();
+    static AudioStats GetStats();
+    static void ResetStats();
+    static int GetActiveVoices() { return activeVoices.load(); }
+
+    // Frees one music stream (and its file data), e.g. when a level's resources are released.
+    static void UnloadMusic(const std::string& name);
+
+    // Switching tracks crossfades: the old one keeps playing while it fades out under the new one.
+    static void PlayMusic(MusicId id, float fadeSeconds = MUSIC_CROSSFADE_SECONDS) { PlayMusicIndex((int)id, fadeSeconds); }
+    static void PlayMusic(const std::string& name);
+    static void StopMusic(float fadeSeconds = MUSIC_STOP_FADE_SECONDS);
+    // Starts decoding a track that will probably be needed soon, so switching to it later is instant.
+    static void PrefetchMusic(MusicId id);
 
     static void SetMusicVolume(float volume);
 
+    // Memory held by decoded sound effects and by owned music file data, for the asset memory report.
+    static size_t GetSoundBytes() { return soundBytes.load(); }
+    static size_t GetMusicBytes() { return musicBytes.load(); }
+
+    // Upper bound on sound effect voices playing at once, over all sounds.
+    static const int MAX_VOICES = 24;
+
 private:
-    static std::map<std::string, Sound> sounds;
-    static std::map<std::string, Music> musics;
+    enum class CommandType { LOAD_SFX, LOAD_MUSIC, UNLOAD_MUSIC, SET_SFX_LIMITS, PLAY_SFX, PLAY_MUSIC, STOP_MUSIC, PREFETCH_MUSIC, MUSIC_VOLUME, QUIT };
+    struct Command {
+        CommandType type;
+        int id;
+        float volume;           // PLAY_SFX, MUSIC_VOLUME
+        float pitch;            // PLAY_SFX
+        int count;              // PLAY_SFX: requests merged into this one. SET_SFX_LIMITS: voice count.
+        float pan;              // PLAY_SFX
+        int priority;           // SET_SFX_LIMITS
+        float seconds;          // PLAY_MUSIC, STOP_MUSIC: fade length.
+        Wave wave;              // LOAD_SFX
+        unsigned char* data;    // LOAD_MUSIC
+        int dataSize;
+        bool takeOwnership;
+        char fileType[8];
+    };
+
+    struct SfxVoice {
+        Sound sound;        // The first voice is the loaded sound, the others are aliases sharing its samples.
+        double startTime;
+    };
+    struct SfxEntry {
+        std::vector<SfxVoice> voices;   // Empty until the sound is loaded.
+        int priority;
+    };
+    struct SfxRequest {
+        int id;
+        float volume;
+        float pitch;
+        float pan;
+        int count;
+    };
+    struct MusicEntry {
+        Music music;
+        bool loaded;
+        unsigned char* ownedData;   // File bytes the stream decodes from, if Audio has to free them.
+        int ownedSize;
+    };
+
+    // Game thread.
+    static void PlaySFXIndex(int id, float volume, float pitch, float pan = 0.5f);
+    static void PlayMusicIndex(int id, float fadeSeconds);
+    static void Send(const Command& cmd);
+    static Command MakeCommand(CommandType type, int id);
+
+    // Audio thread.
+    static void ThreadMain();
+    static void Execute(Command& cmd, int& active);
+    static int CountPlayingVoices();
+    static void StartVoice(const Command& cmd, double now, int& active);
+    static SfxVoice* FindVictim(int maxPriority);
+    static void UnloadSFXEntry(SfxEntry& entry);
+    static void UnloadMusicEntry(int id);
+    static void StartFade(float seconds);
+    static float FadeProgress();
+    static void UpdateMusic(float dt);
+    static void PublishCounters();
+
+    // Game thread state.
+    static std::unordered_map<std::string, int> soundIds;
+    static std::unordered_map<std::string, int> musicIds;
+    static std::vector<SfxRequest> pending;
+    static std::vector<int> pendingIndex;      // Per sound id: its request in 'pending' this frame, or -1.
+    static std::vector<int> sfxPriority;       // Per sound id, as set by SetSFXLimits(); used by the frame budget.
+    static Vector2 listenerPos;
+    static float hearingRadius;
+    static int sfxBudget;
+    static int requestedMusic;
+    static int requestedPrefetch;
+    static float requestedVolume;
+
+    // Audio thread state.
+    static std::vector<SfxEntry> sounds;
+    static std::vector<MusicEntry> musics;
+    // Index of the currently playing music, or -1. It's necessary to know which music to update in the stream loop.
+    static int currentMusic;
+    static int fadingMusic;         // Previous track while it fades out, or -1.
+    static int prefetchedMusic;     // Track with filled buffers, paused until PLAY_MUSIC asks for it, or -1.
+    static float musicVolume;       // Volume of the current track once its fade-in is done.
+    static float fadingVolume;      // Volume the fading track had when the fade started.
+    static float fadeElapsed;
+    static float fadeDuration;
 
-    // Holds the currently playing music. It's necessary to know which music to update in the Update() function.
-    static Music* currentMusic;
+    // Shared.
+    static SpscRing<Command, 1024> commands;
+    static std::thread thread;
+    static std::atomic<int> activeVoices;
+    static std::atomic<size_t> soundBytes;
+    static std::atomic<size_t> musicBytes;
+    static std::atomic<int> statRequests, statCoalesced, statStarted, statStolen, statRestarted, statDropped, statCulled, statOverBudget;
 };
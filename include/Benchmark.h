@@ -0,0 +1,23 @@
+﻿#pragma once
+
+/* HEADLESS BENCHMARK :
+ Runs a level without a window, GPU or audio device: a fixed set of towers is placed along the roads,
+ the World is stepped at a fixed 60 Hz for the given time, and every tick the visible part of the world
+ is drawn through the RECORDER render backend. Per-tick simulation and render times, entity counts and
+ a checksum of the final state are printed to stdout. The same level and seed always give the same
+ checksum, so a run doubles as a determinism check.
+   SiegeOfGondor --bench [--level N] [--seed S] [--seconds T] [--soak] [--lead]      defaults: horde level, seed 1, 60 s
+ --soak makes the castle invulnerable and prints one line per simulated minute (wave, enemies, sim time,
+ memory held by the world), so a long run of the endless level shows leaks or slowdowns as drift.*/
+struct BenchmarkOptions {
+    int level = 4;                      // LevelData::levelID
+    unsigned long long seed = 1;
+    float seconds = 60.0f;
+    bool soak = false;
+    bool lead = false;                  // --lead throws boulders at the intercept point (World::leadTargeting).
+};
+
+// True if the command line asks for the benchmark; fills 'options' from it.
+bool ParseBenchmarkArgs(int argc, char** argv, BenchmarkOptions& options);
+// Returns the process exit code.
+int RunBenchmark(const BenchmarkOptions& options);
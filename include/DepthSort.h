@@ -0,0 +1,45 @@
+﻿#pragma once
+#include <vector>
+
+// Draw layers, lowest first. Inside one layer entities are ordered by the y coordinate of their feet.
+enum class RenderLayer { DECALS = 0, GROUND = 1, AIR = 2 };
+
+// What a render list entry refers to. The index points into the matching entity vector of the frame.
+enum class RenderKind { TOWER, ENEMY, RIDER, PROJECTILE };
+
+struct RenderItem {
+    RenderKind kind;
+    int index;
+};
+
+/* WORLD RENDER LIST :
+ Collects every world entity of a frame with a (layer, y) sort key and orders them back-to-front,
+ so a troll walking behind a tower is hidden by it instead of always being drawn on top.
+ Keys are packed into 32-bit integers and sorted with a stable LSD radix sort.*/
+class WorldRenderList {
+public:
+    void Clear();
+    void Add(RenderLayer layer, float y, RenderKind kind, int index);
+    void Sort();
+
+    // Entries in draw order; only valid after Sort().
+    int Count() const { return (int)sorted.size(); }
+    const RenderItem& operator[](int i) const { return items[sorted[i]]; }
+
+    // How the last Sort() was resolved: 0 = previous order still valid, 1 = repaired with insertion sort, 2 = radix sort.
+    int GetLastSortPath() const { return lastSortPath; }
+    int GetLastRadixPasses() const { return lastRadixPasses; }
+
+private:
+    static unsigned int MakeKey(RenderLayer layer, float y);
+    bool TryPreviousOrder();
+    void RadixSort();
+
+    std::vector<unsigned int> keys;     // Per entry, in Add() order.
+    std::vector<RenderItem> items;      // Per entry, in Add() order.
+    std::vector<unsigned int> sorted;   // Entry indices in draw order.
+    std::vector<unsigned int> scratch;
+
+    int lastSortPath = 2;
+    int lastRadixPasses = 0;
+};
@@ -0,0 +1,111 @@
+﻿#pragma once
+#include "raylib.h"
+#include "Enemy.h"
+#include <cmath>
+#include <vector>
+
+/* ENEMY GRID :
+ Uniform grid over the map, rebuilt from the enemy list once per simulation tick. Enemies are bucketed
+ with a counting sort, so the build is two linear passes and every cell is a contiguous run of entries.
+ Each entry carries the enemy's position and hitbox radius next to its index, so range tests read one
+ small array instead of touching the Enemy objects. Indices are only valid until the enemy list changes.*/
+class EnemyGrid {
+public:
+    // Cell edge in pixels; about half the longest tower range, so a range query covers a handful of cells.
+    static constexpr float CELL_SIZE = 128.0f;
+    // Largest 'k' FindNearest() answers; bigger requests are clamped.
+    static constexpr int MAX_NEAREST = 32;
+
+    void Build(const std::vector<Enemy>& enemies, float worldWidth, float worldHeight);
+
+    // Calls fn(enemyIndex) for every enemy whose hitbox overlaps the circle, i.e. the same test as
+    // CheckCollisionCircles(center, radius, e.GetPosition(), e.GetRadius()). Enemies are as of Build(), so
+    // callers still check IsAlive(). fn returns false to stop the query early.
+    template <typename Fn>
+    void ForEachInRange(Vector2 center, float radius, Fn fn) const {
+        if (entries.empty()) return;
+        float reach = radius + maxRadius;
+        int x0, y0, x1, y1;
+        CellRange(center, reach, x0, y0, x1, y1);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                int cell = cy * cols + cx;
+                for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                    const Entry& e = entries[k];
+                    float dx = e.x - center.x;
+                    float dy = e.y - center.y;
+                    float r = radius + e.radius;
+                    if (dx * dx + dy * dy <= r * r && !fn(e.index)) return;
+                }
+            }
+        }
+    }
+
+    /* K NEAREST :
+     Writes to 'out' the indices of up to 'k' enemies for which accept(enemyIndex) is true, nearest first,
+     and returns how many it found. Distance is measured to the edge of the hitbox, so the enemies returned
+     are among those ForEachInRange() would visit for the same circle. Cells are visited in square rings around the cell of
+     'center'; the search stops at the first ring that cannot hold anything closer than the k-th enemy
+     found so far, so a query usually reads only the cells next to 'center' however many enemies there are.
+     accept() is only asked about enemies that would make the list, so it may be a lookup into a small
+     "already hit" set.*/
+    template <typename Fn>
+    int FindNearest(Vector2 center, float radius, int k, int* out, Fn accept) const {
+        if (entries.empty() || k <= 0) return 0;
+        if (k > MAX_NEAREST) k = MAX_NEAREST;
+        float best[MAX_NEAREST];
+        int found = 0;
+        int home = CellOf(center.x, center.y);
+        int hx = home % cols, hy = home / cols;
+        int lastRing = (int)((radius + maxRadius) / CELL_SIZE) + 1;
+        for (int ring = 0; ring <= lastRing; ring++) {
+            // Anything in this ring or beyond is at least this far from 'center'.
+            float ringMin = (ring - 1) * CELL_SIZE - maxRadius;
+            if (ring > 0 && (ringMin > radius || (found == k && ringMin > best[k - 1]))) break;
+            for (int cy = hy - ring; cy <= hy + ring; cy++) {
+                if (cy < 0 || cy >= rows) continue;
+                // Rows at the top and bottom of the ring are whole; in between only its two side cells.
+                int step = (cy == hy - ring || cy == hy + ring) ? 1 : 2 * ring;
+                for (int cx = hx - ring; cx <= hx + ring; cx += step) {
+                    if (cx < 0 || cx >= cols) continue;
+                    int cell = cy * cols + cx;
+                    for (int n = cellStart[cell]; n < cellStart[cell + 1]; n++) {
+                        const Entry& e = entries[n];
+                        float dx = e.x - center.x;
+                        float dy = e.y - center.y;
+                        // Negative inside the hitbox, so overlapping enemies are still ordered by their centers.
+                        float d = sqrtf(dx * dx + dy * dy) - e.radius;
+                        if (d > radius || (found == k && d >= best[k - 1]) || !accept(e.index)) continue;
+                        // Insertion into the sorted list; the k-th entry falls off when it is full.
+                        int slot = (found < k) ? found++ : k - 1;
+                        while (slot > 0 && best[slot - 1] > d) { best[slot] = best[slot - 1]; out[slot] = out[slot - 1]; slot--; }
+                        best[slot] = d;
+                        out[slot] = e.index;
+                    }
+                }
+            }
+        }
+        return found;
+    }
+
+    int Count() const { return (int)entries.size(); }
+    int GetCellCount() const { return cols * rows; }
+    size_t GetMemoryBytes() const { return cellStart.capacity() * sizeof(int) + entries.capacity() * sizeof(Entry) + cellOfEnemy.capacity() * sizeof(int); }
+
+private:
+    struct Entry {
+        float x, y;
+        float radius;
+        int index;
+    };
+
+    int CellOf(float x, float y) const;
+    void CellRange(Vector2 center, float reach, int& x0, int& y0, int& x1, int& y1) const;
+
+    int cols = 0;
+    int rows = 0;
+    float maxRadius = 0.0f;
+    std::vector<int> cellStart;     // cols * rows + 1 offsets into 'entries'.
+    std::vector<Entry> entries;     // Grouped by cell.
+    std::vector<int> cellOfEnemy;   // Scratch for the counting sort, -1 for dead enemies.
+};
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include "raylib.h"
+#include "Tower.h"
+
+// Dirty flags of the HUD model. Each setter raises only the flag of the value that actually changed.
+enum HudDirtyFlags {
+    HUD_DIRTY_NONE = 0,
+    HUD_DIRTY_GOLD = 1 << 0,
+    HUD_DIRTY_WAVE = 1 << 1,
+    HUD_DIRTY_TOWER = 1 << 2,
+    HUD_DIRTY_BLOOD = 1 << 3,
+    HUD_DIRTY_HOVER = 1 << 4,
+    HUD_DIRTY_BAR = HUD_DIRTY_GOLD | HUD_DIRTY_WAVE | HUD_DIRTY_TOWER | HUD_DIRTY_BLOOD,
+    HUD_DIRTY_ALL = 0xFF
+};
+
+/* RETAINED HUD :
+ The bottom bar (gold, wave, tower selection, blood gauge, ability labels) and the MENU button are
+ two panels, each drawn once into a render texture of its own size. Every frame only the two textures
+ are drawn, one quad each; a panel is recomposed only when one of its values changes, so gold ticking
+ up redraws the bar and leaves the button alone, and hovering the button leaves the bar alone.*/
+class Hud {
+public:
+    void Init(int width, int height, Texture2D btnNormal, Texture2D btnHover, int maxBlood, int costGandalf, int costRohirrim);
+    void Unload();
+
+    void SetGold(int value);
+    void SetWave(int index, int count);     // count 0: endless, no total shown.
+    void SetSelectedTower(TowerType type);
+    void SetUrukBlood(int value);
+    void SetMenuButtonState(bool hover, bool pressed);
+    void MarkDirty(unsigned int flags) { dirty |= flags; }
+
+    unsigned int GetDirtyFlags() const { return dirty; }
+    int GetRecomposeCount() const { return recomposeCount; }
+    Rectangle GetMenuButtonRect() const { return menuButton; }
+
+    // Draws the cached HUD. 'outerTarget' is the render texture currently bound; it is re-bound after a recompose.
+    void Draw(RenderTexture2D outerTarget);
+
+private:
+    static const int BAR_HEIGHT = 60;
+
+    void RecomposeBar();
+    void RecomposeButton();
+
+    RenderTexture2D barTexture = { 0 };         // width x BAR_HEIGHT, the bottom of the screen.
+    RenderTexture2D buttonTexture = { 0 };      // The size of 'menuButton'.
+    Texture2D texBtnNormal = { 0 };
+    Texture2D texBtnHover = { 0 };
+    int width = 0;
+    int height = 0;
+    Rectangle menuButton = { 0 };
+
+    int maxBlood = 100;
+    int costGandalf = 0;
+    int costRohirrim = 0;
+
+    int gold = 0;
+    int waveIndex = 0;
+    int waveCount = 0;
+    TowerType selectedTower = TowerType::ARCHER;
+    int urukBlood = 0;
+    bool menuHover = false;
+    bool menuPressed = false;
+
+    unsigned int dirty = HUD_DIRTY_ALL;
+    int recomposeCount = 0;
+};
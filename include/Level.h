@@ -0,0 +1,62 @@
+﻿#pragma once
+#include "raylib.h"
+#include "Enemy.h"
+#include <string>
+#include <vector>
+
+
+const int TILE_SIZE = 64;
+const int MAP_ROWS = 12;
+
+
+struct EnemyWave {
+    int enemyCount;
+    EnemyType enemyType;
+    float spawnInterval;
+    float speedMultiplier;
+    int healthBonus;
+};
+
+
+struct LevelTrack {
+    const char* name;
+    const char* path;
+};
+
+
+struct LevelData {
+    int levelID;
+    const char* name;
+    Texture2D background;
+    const char* backgroundPath;
+    Color bgColor;
+
+    // Music that only this level plays. Loaded with the background when the level is picked, see LevelResources.
+    std::vector<LevelTrack> music;
+
+    std::vector<std::vector<int>> tileMap;
+    std::vector<std::vector<Vector2>*> paths;
+    int startGold;
+    int mapWidth;
+    int cols;
+
+    Vector2 castlePos;
+    float castleScale;
+    std::vector<EnemyWave> waves;
+
+    std::vector<std::string> storyLines;
+
+    // Stress level: the castle takes no damage, enemies reaching it are only counted.
+    bool horde = false;
+    // 'waves' is empty; waves are generated one at a time from the run's seed, see GenerateEndlessWave().
+    bool endless = false;
+};
+
+// The built-in levels (Level.cpp). Paths are heap-allocated; DestroyLevels() frees them.
+std::vector<LevelData> CreateLevels();
+void DestroyLevels(std::vector<LevelData>& levels);
+std::vector<std::vector<Vector2>*> GeneratePathsFromMap(const std::vector<std::vector<int>>& map);
+
+EnemyWave GenerateEndlessWave(unsigned long long seed, int index);
+// Wave 'index' of 'level' into 'out'. False once a level has run out of waves; endless levels never do.
+bool GetLevelWave(const LevelData& level, unsigned long long seed, int index, EnemyWave& out);
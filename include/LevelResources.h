@@ -0,0 +1,32 @@
+﻿#pragma once
+#include "Level.h"
+#include "AssetLoader.h"
+#include <memory>
+
+/* LEVEL-SCOPED RESOURCES :
+ The background texture and the music of a level are only held while that level is being played.
+ Prefetch() is called when the level is picked: the files are decoded on a worker thread while the
+ LEVEL_INTRO story text is on screen, and Pump() uploads them a little per frame. Acquire() makes
+ sure everything is in place before GAMEPLAY starts, Release() frees it once the player leaves the
+ VICTORY/GAMEOVER screen, after the level music has faded out under the end theme.*/
+class LevelResources {
+public:
+    ~LevelResources() { Release(); }
+
+    // Where prefetches read from; both optional, like for the startup loader.
+    void SetSources(const AssetArchive* pak, TextureCache* cache) { archive = pak; textureCache = cache; }
+
+    void Prefetch(LevelData& level);
+    void Pump(double budgetMs);
+    void Acquire();
+    void Release();
+
+    bool IsReady() const { return level != nullptr && (!loader || loader->IsDone()); }
+    const LevelData* GetLevel() const { return level; }
+
+private:
+    LevelData* level = nullptr;
+    const AssetArchive* archive = nullptr;
+    TextureCache* textureCache = nullptr;
+    std::unique_ptr<AssetLoader> loader;
+};
@@ -0,0 +1,64 @@
+﻿#pragma once
+#include "raylib.h"
+#include "DepthSort.h"
+#include <vector>
+
+// Typed emitters. Each one owns its own particle pool, so a pool is always updated with constant parameters.
+enum class EmitterType { BLOOD, ICE_SHATTER, GANDALF_SPARK, ROHIRRIM_DUST, COUNT };
+
+struct EmitterConfig {
+    Texture2D texture;      // Horizontal frame strip; id 0 draws flat colored squares instead.
+    int frames;             // Frames in the strip.
+    float frameTime;        // Seconds per frame.
+    float life;             // Seconds a particle lives.
+    int burst;              // Particles per Emit() at full detail.
+    float speedMin;         // Initial speed range, in a random direction (pixels per second).
+    float speedMax;
+    float gravity;          // Added to the vertical velocity every second (negative rises).
+    float size;             // Drawn size in pixels; 0 uses the frame size.
+    Color color;
+    bool fade;              // Fade alpha out over the lifetime.
+    RenderLayer layer;      // DECALS draws below units, AIR above them.
+};
+
+/* PARTICLE ENGINE :
+ Replaces the old single-purpose BloodManager. Particle data is stored structure-of-arrays per emitter
+ (positions, velocities and ages in separate float arrays), so Update() is a few straight loops over
+ contiguous floats that the compiler can vectorize, followed by a swap-with-last compaction.
+ A global budget caps the total particle count; as the count approaches it, emission is thinned
+ (level of detail) instead of spawning particles that would be culled anyway.*/
+class ParticleSystem {
+public:
+    ParticleSystem();
+
+    void Configure(EmitterType type, const EmitterConfig& config);
+    void SetBudget(int maxParticles) { budget = maxParticles; }
+    int GetBudget() const { return budget; }
+
+    // 'amount' scales the burst, e.g. rate * dt for continuous emitters such as dust trails.
+    void Emit(EmitterType type, Vector2 position, float amount = 1.0f);
+    void Update(float dt);
+    void Draw(RenderLayer layer) const;
+    void Clear();
+
+    int Count() const;
+    // 1.0 = full detail, lower values mean bursts are currently being thinned.
+    float GetDetailLevel() const;
+
+private:
+    struct Pool {
+        EmitterConfig config;
+        std::vector<float> posX, posY;
+        std::vector<float> velX, velY;
+        std::vector<float> age;
+        int Size() const { return (int)age.size(); }
+    };
+
+    float RandomFloat(float min, float max);
+    static void UpdatePool(Pool& pool, float dt);
+    static void DrawPool(const Pool& pool);
+
+    Pool pools[(int)EmitterType::COUNT];
+    int budget;
+    unsigned int rngState;
+};
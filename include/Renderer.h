@@ -0,0 +1,111 @@
+﻿#pragma once
+#include "raylib.h"
+#include <vector>
+
+// One glyph of a laid-out string: where it is in the font atlas and where it goes relative to the text position.
+struct GlyphQuad {
+    Rectangle source;
+    Rectangle dest;
+};
+
+// Selects where draw calls go. RAYLIB forwards them to the GPU, RECORDER only captures them (no window or GPU needed).
+enum class RenderBackend { RAYLIB, RECORDER };
+
+enum class DrawCommandType {
+    CLEAR,
+    TEXTURE,
+    RECTANGLE,
+    RECTANGLE_LINES,
+    RECTANGLE_GRADIENT,
+    CIRCLE,
+    CIRCLE_LINES,
+    LINE,
+    TEXT,
+    BEGIN_MODE2D,
+    END_MODE2D,
+    BEGIN_TARGET,
+    END_TARGET,
+    BLEND_MODE
+};
+
+// One recorded draw call. 'textureId' is the GPU texture the call samples from, it is what raylib batches on.
+struct DrawCommand {
+    DrawCommandType type;
+    unsigned int textureId;
+    Rectangle source;
+    Rectangle dest;
+    Vector2 origin;
+    float rotation;     // Degrees for textures, radius for circles, line thickness for outlines and lines.
+    Color color;
+    Color color2;       // Bottom color of vertical gradients.
+    int blendMode;      // BLEND_MODE only.
+    int textOffset;     // Offset of the string inside the frame text buffer (TEXT only).
+    int fontSize;
+    Camera2D camera;    // BEGIN_MODE2D only.
+};
+
+struct RenderStats {
+    int drawCalls;       // Commands that actually produce geometry.
+    int batchBreaks;     // Texture switches and mode/target changes; each one flushes raylib's batch.
+    int textureSwitches;
+    int textCalls;
+    int uniqueTextures;
+    double cpuMs;        // Time spent between BeginFrame() and EndFrame().
+};
+
+class Renderer {
+public:
+    static void SetBackend(RenderBackend backend);
+    static RenderBackend GetBackend() { return backend; }
+
+    // Frame bracketing: resets the command stream and the counters, then measures CPU-side cost.
+    static void BeginFrame();
+    static void EndFrame();
+
+    static void ClearBackground(Color color);
+    static void BeginMode2D(Camera2D camera);
+    static void EndMode2D();
+    static void BeginTextureMode(RenderTexture2D target);
+    static void EndTextureMode();
+    static void BeginBlendMode(int mode);
+    static void EndBlendMode();
+
+    static void DrawTexturePro(Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint);
+    static void DrawRectangle(int posX, int posY, int width, int height, Color color);
+    static void DrawRectangleRec(Rectangle rec, Color color);
+    static void DrawRectangleLines(int posX, int posY, int width, int height, Color color);
+    static void DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color);
+    static void DrawRectangleGradientV(int posX, int posY, int width, int height, Color top, Color bottom);
+    static void DrawCircleV(Vector2 center, float radius, Color color);
+    static void DrawCircleLines(int centerX, int centerY, float radius, Color color);
+    // Recorded with the start point in dest.x/y and the end point in dest.width/height.
+    static void DrawLineEx(Vector2 start, Vector2 end, float thick, Color color);
+    static void DrawText(const char* text, int posX, int posY, int fontSize, Color color);
+    // 'text' already laid out by TextCache: the glyph quads are drawn from 'font' and the whole string is
+    // counted as one text draw, like DrawText(), rather than one texture draw per glyph.
+    static void DrawGlyphRun(const char* text, Texture2D font, const GlyphQuad* glyphs, int count, int posX, int posY, int fontSize, Color color);
+
+    // Recorded stream of the last frame (RECORDER backend only) and the counters of the last frame (both backends).
+    static const std::vector<DrawCommand>& GetCommands() { return commands; }
+    static const char* GetCommandText(const DrawCommand& cmd) { return &textBuffer[cmd.textOffset]; }
+    static RenderStats GetStats() { return lastStats; }
+
+    // Software rasterizer: replays the recorded stream into a CPU image (R8G8B8A8). Textures are filled with a
+    // flat color derived from their id, text with its bounding box; the point is to measure cost, not to look right.
+    static void Replay(Image& canvas);
+
+private:
+    static void Record(const DrawCommand& cmd);
+    static void RecordText(const char* text, int posX, int posY, int fontSize, Color color);
+    static void CountState(DrawCommandType type, unsigned int textureId);
+
+    static RenderBackend backend;
+    static std::vector<DrawCommand> commands;
+    static std::vector<char> textBuffer;
+    static std::vector<unsigned int> seenTextures;
+
+    static RenderStats stats;
+    static RenderStats lastStats;
+    static unsigned int lastTextureId;
+    static double frameStart;
+};
@@ -0,0 +1,36 @@
+﻿#pragma once
+
+/* SIMULATION RNG :
+ Every random decision that changes the simulation (which path an enemy takes, ...) is drawn from
+ this generator instead of raylib's GetRandomValue(), so a run is reproducible from its seed and the
+ whole state fits in one integer. Purely cosmetic randomness (sound pitch, particles) keeps using
+ GetRandomValue(); it never feeds back into the simulation.
+ PCG32 (XSH-RR variant): 64-bit state, 32-bit output, good enough statistics for gameplay.*/
+struct Rng {
+    unsigned long long state = 0x853C49E6748FEA9BULL;
+
+    void Seed(unsigned long long seed) {
+        state = 0;
+        Next();
+        state += seed;
+        Next();
+    }
+
+    unsigned int Next() {
+        unsigned long long old = state;
+        state = old * 6364136223846793005ULL + 1442695040888963407ULL;
+        unsigned int xorshifted = (unsigned int)(((old >> 18u) ^ old) >> 27u);
+        unsigned int rot = (unsigned int)(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+    }
+
+    // Inclusive on both ends, like GetRandomValue().
+    int Range(int min, int max) {
+        if (max <= min) return min;
+        unsigned int span = (unsigned int)(max - min) + 1u;
+        return min + (int)(Next() % span);
+    }
+
+    // [0, 1)
+    float Float() { return (Next() >> 8) * (1.0f / 16777216.0f); }
+};
@@ -0,0 +1,56 @@
+﻿#pragma once
+#include <vector>
+
+/* SAVE STATES (.sav) :
+ The complete simulation state of a World: economy, castle, wave cursor, timers, RNG and every enemy,
+ tower, projectile and rider. Particles, sounds and the camera are presentation and are not saved.
+ Layout (host byte order; a save only loads on a machine with the same endianness, which every
+ platform the game builds for shares):
+   SnapshotHeader                     magic "SGSV", version, total size, level id, entity counts
+   WorldSnapshotState                 the World's own fields
+   EnemyState[enemyCount]             see Enemy.h
+   TowerState[towerCount]             see Tower.h
+   ProjectileState[projectileCount]   see Projectile.h
+   RiderState[riderCount]             see World.h
+   EffectState[effectCount]           see StatusEffects.h
+ Every record is a fixed-size struct without padding, copied as-is. Writing is one resize of a reused
+ buffer plus a memcpy per record; reading checks the whole buffer once, then constructs the entities in
+ vectors reserved up front. A snapshot with another version is rejected, not converted: bump
+ SNAPSHOT_VERSION whenever one of the records changes.*/
+
+const unsigned int SNAPSHOT_MAGIC = 0x56534753;  // "SGSV"
+const unsigned int SNAPSHOT_VERSION = 5;
+
+struct SnapshotHeader {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int size;              // Whole snapshot, header included.
+    int levelID;
+    int enemyCount;
+    int towerCount;
+    int projectileCount;
+    int riderCount;
+    int effectCount;
+};
+
+struct WorldSnapshotState {
+    unsigned long long rngState;
+    unsigned long long waveSeed;
+    int gold;
+    int urukBlood;
+    int castleHealth;
+    int currentWaveIndex;
+    int enemiesSpawnedInWave;
+    float spawnTimer;
+    float waveDelayTimer;
+    float walkSoundTimer;
+    int isBossActive;
+    int castleInvulnerable;
+    int outcome;
+    int totalSpawned;
+    int totalKilled;
+    int totalLeaked;
+};
+
+bool WriteSnapshotFile(const char* path, const std::vector<unsigned char>& data);
+bool ReadSnapshotFile(const char* path, std::vector<unsigned char>& data);
@@ -0,0 +1,96 @@
+﻿#pragma once
+#include "World.h"
+#include <vector>
+
+/* SNAPSHOT HISTORY :
+ A ring of save states (Snapshot.h) taken at a fixed interval of simulated time, for rewinding while
+ debugging a late-wave problem. To keep the ring small, most entries are deltas: the snapshot XORed
+ with the one before it, then run-length encoded. Entities that did not change, and the high bytes of
+ positions and timers that changed only a little, XOR to runs of zeros. Every 'keyframeEvery'-th entry
+ is a keyframe, encoded against nothing, so restoring never decodes more than one group of entries.
+ When the ring is full the oldest whole group is dropped; see TrimToBudget() for the byte budget.
+ Separately, a keyframe is kept for the first tick of each of the last 'maxWaveStarts' waves, so a
+ jump to the start of a wave never depends on how far back the ring reaches.
+ Entry buffers are reused once the ring has wrapped around, so in the steady state recording does not
+ allocate.*/
+struct SnapshotHistoryConfig {
+    float intervalSeconds = 1.0f;
+    float historySeconds = 300.0f;
+    int keyframeEvery = 10;
+    int maxWaveStarts = 64;
+    // Budget for all the buffers the history holds: entries, wave-start keyframes and the two raw snapshots. On crowded levels a delta
+    // is around a megabyte, so the byte budget, not 'historySeconds', decides how far back a rewind can go.
+    size_t maxBytes = 32u * 1024u * 1024u;
+};
+
+// What the game and the benchmark record for 'level'. The horde level keeps one minute at one snapshot
+// every two seconds: with 50,000 enemies a snapshot is over 3 MB and each encode takes several ms.
+SnapshotHistoryConfig HistoryConfigFor(const LevelData& level);
+
+class SnapshotHistory {
+public:
+    void Configure(const SnapshotHistoryConfig& config);
+    const SnapshotHistoryConfig& GetConfig() const { return config; }
+    // Forgets everything; call when a level starts.
+    void Clear();
+
+    // Once per simulation step, after World::Update(). Takes a snapshot when the interval has elapsed
+    // or a new wave has started.
+    void Record(const World& world, float dt);
+
+    // Restores the newest snapshot at least 'seconds' old (or the oldest one kept). The history after it
+    // is discarded, so recording continues on the new timeline. Returns the seconds actually rewound,
+    // or a negative value if there is nothing to restore.
+    float Rewind(World& world, float seconds);
+    // Restores the first tick of wave 'waveIndex' if it is still kept. The history after it is discarded.
+    bool JumpToWave(World& world, int waveIndex);
+    // Index of the oldest wave whose start can still be jumped to, or -1.
+    int GetOldestWave() const { return waveStarts.empty() ? -1 : waveStarts.front().wave; }
+    // Simulated seconds since the last wave start that JumpToWave() could restore.
+    float GetSecondsSinceWaveStart() const { return waveStarts.empty() ? -1.0f : (float)(clock - waveStarts.back().time); }
+
+    int Count() const { return count; }
+    float GetCoveredSeconds() const;
+    size_t GetMemoryBytes() const;
+    // Encoded bytes per minute of history, measured over what the ring holds now.
+    float GetBytesPerMinute() const;
+    double GetLastRecordMs() const { return lastRecordMs; }
+
+private:
+    struct Entry {
+        double time = 0.0;
+        int wave = 0;
+        bool keyframe = false;
+        size_t rawSize = 0;
+        std::vector<unsigned char> data;
+    };
+    struct WaveStart {
+        int wave;
+        double time;
+        std::vector<unsigned char> data;    // Raw snapshot.
+    };
+
+    Entry& At(int i) { return ring[(head + i) % ring.size()]; }
+    const Entry& At(int i) const { return ring[(head + i) % ring.size()]; }
+    void Push(const World& world);
+    void DropOldestGroup();
+    size_t GetEncodedBytes() const;     // Of the entries in the ring.
+    size_t GetHeldBytes() const;        // Capacity of every buffer, spare ones included.
+    void TrimToBudget();
+    bool Decode(int index, std::vector<unsigned char>& out);
+    bool Restore(World& world, const std::vector<unsigned char>& raw, double time);
+
+    SnapshotHistoryConfig config;
+    std::vector<Entry> ring;
+    int head = 0;
+    int count = 0;
+    int sinceKeyframe = 0;
+    bool forceKeyframe = true;
+    double clock = 0.0;
+    double nextCapture = 0.0;
+    int lastWave = -1;
+    std::vector<WaveStart> waveStarts;
+    std::vector<unsigned char> previous;    // Raw form of the newest entry, the base of the next delta.
+    std::vector<unsigned char> current;     // Scratch.
+    double lastRecordMs = 0.0;
+};
@@ -0,0 +1,41 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+
+/* SINGLE-PRODUCER / SINGLE-CONSUMER RING :
+ Fixed-size queue for handing commands from exactly one thread to exactly one other thread without
+ locks. The producer only writes 'head', the consumer only writes 'tail'; each reads the other's index
+ with acquire ordering, which makes the slot contents written before the matching release visible.
+ 'Capacity' must be a power of two; one slot is kept free to tell "full" from "empty".*/
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    // Producer thread. Returns false if the ring is full.
+    bool Push(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t next = (h + 1) & (Capacity - 1);
+        if (next == tail.load(std::memory_order_acquire)) return false;
+        slots[h] = item;
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread. Returns false if the ring is empty.
+    bool Pop(T& out) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        out = slots[t];
+        tail.store((t + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool IsEmpty() const { return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire); }
+
+private:
+    T slots[Capacity];
+    // On separate cache lines, so producer and consumer do not invalidate each other's index on every push/pop.
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+};
@@ -0,0 +1,170 @@
+﻿#pragma once
+#include "Enemy.h"
+#include <vector>
+
+enum class EffectKind { STUN, SLOW, BURN, POISON, ARMOR_SHRED, FEAR, COUNT };
+
+enum class EffectStacking {
+    // One instance per enemy. A reapplication at least as strong keeps the longer of the two timers; a
+    // weaker one takes over only once it would outlast the current one.
+    REFRESH,
+    // One instance per enemy with a stack count up to 'maxStacks'. Each application adds a stack and
+    // restarts the timer; the magnitude is per stack.
+    INTENSITY
+};
+
+struct EffectRule {
+    bool enabled;           // Apply() ignores a disabled kind, so its sources change nothing.
+    EffectStacking stacking;
+    int maxStacks;          // INTENSITY only.
+    bool decayByStack;      // INTENSITY only: when the timer runs out, lose one stack and restart it instead of all of them.
+    bool bossesImmune;
+};
+
+/* DEFAULT RULES :
+ stun and slow refresh (a second ice bolt does not slow twice as much), burn refreshes, poison builds up
+ to five stacks that wear off one at a time, armor shred builds up to five stacks that all drop when
+ the timer runs out, and fear refreshes and does not work on bosses.
+ Only stun and slow are enabled, which keeps the towers and Gandalf as balanced. The other kinds are
+ wired to their sources (boulders burn, arrows poison, lightning shreds armor, Gandalf's stun is
+ followed by fear) and are turned on with StatusEffects::SetRule().*/
+// Without an initializer of its own, a new kind would silently get an all-zero rule.
+static_assert((int)EffectKind::COUNT == 6, "add a DEFAULT_EFFECT_RULES entry for the new EffectKind");
+const EffectRule DEFAULT_EFFECT_RULES[(int)EffectKind::COUNT] = {
+    { true, EffectStacking::REFRESH, 1, false, false },         // STUN
+    { true, EffectStacking::REFRESH, 1, false, false },         // SLOW          magnitude: fraction of speed taken away
+    { false, EffectStacking::REFRESH, 1, false, false },        // BURN          magnitude: damage per second
+    { false, EffectStacking::INTENSITY, 5, true, false },       // POISON        magnitude: damage per second per stack
+    { false, EffectStacking::INTENSITY, 5, false, false },      // ARMOR_SHRED   magnitude: extra damage taken per stack
+    { false, EffectStacking::REFRESH, 1, false, true },         // FEAR          magnitude: fraction of speed kept while fleeing
+};
+
+// Save-state record of one effect instance (see Snapshot.h). All fields are 4 bytes wide, so there is no padding.
+struct EffectState {
+    int kind;
+    int targetSlot;
+    unsigned int targetGeneration;
+    float timeLeft;
+    float duration;
+    float magnitude;
+    int stacks;
+    float pending;
+};
+
+/* STATUS EFFECTS :
+ Every effect instance lives in the list of its kind, a compact array of small records, instead of in
+ the enemy. Ticking walks one list at a time with the same few operations for every record (timer
+ down, maybe damage), so a thousand enemies with several effects each cost a handful of tight loops.
+ Then the lists are folded into each enemy's EnemyStatus, which is all Enemy::Update() and
+ Enemy::TakeDamage() look at.
+ Instances point at their enemy by EnemyHandle, so swap-with-last removals in the enemy list need no
+ bookkeeping here; an instance whose enemy is gone is dropped on the next tick. Per kind, a table
+ from handle slot to list position finds an enemy's instance in O(1) when an effect is applied.*/
+class StatusEffects {
+public:
+    StatusEffects() {
+        for (int k = 0; k < (int)EffectKind::COUNT; k++) rules[k] = DEFAULT_EFFECT_RULES[k];
+    }
+
+    void Clear();
+    void SetRule(EffectKind kind, const EffectRule& rule) { rules[(int)kind] = rule; }
+    const EffectRule& GetRule(EffectKind kind) const { return rules[(int)kind]; }
+
+    // Starts or stacks an effect on 'enemy' following the rule of its kind.
+    void Apply(Enemy& enemy, EffectKind kind, float duration, float magnitude);
+
+    /* TICK :
+     Counts every timer down by 'dt', deals burn and poison damage, drops expired instances and those
+     whose enemy is dead or gone, then rewrites the EnemyStatus of every enemy. 'resolve' maps an
+     EnemyHandle to an index into 'enemies' or -1 (World::Resolve).*/
+    template <typename Resolve>
+    void Tick(float dt, std::vector<Enemy>& enemies, Resolve resolve) {
+        for (int k = 0; k < (int)EffectKind::COUNT; k++) {
+            std::vector<Instance>& list = lists[k];
+            const EffectRule& rule = rules[k];
+            bool damaging = (k == (int)EffectKind::BURN || k == (int)EffectKind::POISON);
+            for (size_t i = 0; i < list.size();) {
+                Instance& e = list[i];
+                int index = resolve(e.target);
+                if (index < 0 || !enemies[index].IsAlive()) { Remove(k, i); continue; }
+                if (damaging) {
+                    // Damage piles up below one hit point until it is worth a hit.
+                    e.pending += e.magnitude * e.stacks * dt;
+                    if (e.pending >= 1.0f) {
+                        int hit = (int)e.pending;
+                        e.pending -= hit;
+                        enemies[index].TakeDamage(hit);
+                    }
+                }
+                e.timeLeft -= dt;
+                if (e.timeLeft <= 0.0f) {
+                    if (rule.decayByStack && e.stacks > 1) { e.stacks--; e.timeLeft += e.duration; }
+                    else { Remove(k, i); continue; }
+                }
+                i++;
+            }
+        }
+        Publish(enemies, resolve);
+    }
+
+    // Rewrites every enemy's EnemyStatus from the lists without advancing time (after loading).
+    template <typename Resolve>
+    void Publish(std::vector<Enemy>& enemies, Resolve resolve) {
+        for (Enemy& e : enemies) e.SetStatus(EnemyStatus());
+        for (const Instance& e : lists[(int)EffectKind::STUN]) {
+            int index = resolve(e.target);
+            if (index >= 0) enemies[index].EditStatus().stun = e.timeLeft;
+        }
+        for (const Instance& e : lists[(int)EffectKind::SLOW]) {
+            int index = resolve(e.target);
+            if (index < 0) continue;
+            EnemyStatus& s = enemies[index].EditStatus();
+            s.slow = e.timeLeft;
+            s.slowFactor = 1.0f - e.magnitude;
+        }
+        for (const Instance& e : lists[(int)EffectKind::FEAR]) {
+            int index = resolve(e.target);
+            if (index < 0) continue;
+            EnemyStatus& s = enemies[index].EditStatus();
+            s.fear = e.timeLeft;
+            s.fearSpeed = e.magnitude;
+        }
+        for (const Instance& e : lists[(int)EffectKind::ARMOR_SHRED]) {
+            int index = resolve(e.target);
+            if (index >= 0) enemies[index].EditStatus().damageTakenScale = 1.0f + e.magnitude * e.stacks;
+        }
+        for (const Instance& e : lists[(int)EffectKind::BURN]) {
+            int index = resolve(e.target);
+            if (index >= 0) enemies[index].EditStatus().burning = true;
+        }
+        for (const Instance& e : lists[(int)EffectKind::POISON]) {
+            int index = resolve(e.target);
+            if (index >= 0) enemies[index].EditStatus().poisoned = true;
+        }
+    }
+
+    int Count() const;
+    int Count(EffectKind kind) const { return (int)lists[(int)kind].size(); }
+    size_t GetMemoryBytes() const;
+
+    // Save states: writes Count() EffectState records to 'out' / rebuilds the lists from 'count' records
+    // that the caller has validated. Records are memcpy'd, so the buffers need no alignment.
+    void Save(unsigned char* out) const;
+    void Load(const unsigned char* data, int count);
+
+private:
+    struct Instance {
+        EnemyHandle target;
+        float timeLeft;
+        float duration;     // Of the last application; a decaying stack restarts with it.
+        float magnitude;
+        int stacks;
+        float pending;
+    };
+
+    void Remove(int kind, size_t i);
+
+    EffectRule rules[(int)EffectKind::COUNT];
+    std::vector<Instance> lists[(int)EffectKind::COUNT];
+    std::vector<int> entryOfSlot[(int)EffectKind::COUNT];   // By EnemyHandle::slot, -1 for none.
+};
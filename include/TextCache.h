@@ -0,0 +1,50 @@
+﻿#pragma once
+#include "raylib.h"
+#include "Renderer.h"
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* GLYPH-RUN CACHE :
+ Replacement for DrawText/MeasureText with the default font. The first time a (string, font size)
+ pair is seen it is laid out exactly like raylib does it, and the measured width plus the list of
+ glyph quads are kept. Later calls skip UTF-8 decoding, glyph lookup and measuring and just emit the
+ quads. Entries are evicted least-recently-used once the capacity is reached.*/
+class TextCache {
+public:
+    static int Measure(const char* text, int fontSize);
+    static void Draw(const char* text, int posX, int posY, int fontSize, Color color);
+
+    static void SetCapacity(int maxEntries);
+    static void Clear();
+
+    static int GetHits() { return hits; }
+    static int GetMisses() { return misses; }
+    static int GetEvictions() { return evictions; }
+
+    /* NUMERIC FIELDS :
+     Writes "<prefix><value><suffix>" into a caller-owned buffer and returns it. Unlike TextFormat()
+     nothing is shared between calls, so HUD fields can keep their strings as long as they need them.*/
+    static const char* Format(char* buffer, int size, const char* prefix, int value, const char* suffix = "");
+    static const char* Format(char* buffer, int size, const char* prefix, int a, const char* middle, int b, const char* suffix = "");
+
+private:
+    struct Entry {
+        unsigned long long key;
+        std::string text;
+        int fontSize;
+        int width;
+        std::vector<GlyphQuad> glyphs;
+    };
+
+    static Entry* Lookup(const char* text, int fontSize);
+    static void Layout(Entry& entry);
+
+    static std::list<Entry> entries;   // Most recently used at the front.
+    static std::unordered_map<unsigned long long, std::list<Entry>::iterator> index;
+    static int capacity;
+    static int hits;
+    static int misses;
+    static int evictions;
+};
@@ -0,0 +1,79 @@
+﻿#pragma once
+#include "raylib.h"
+#include "AssetArchive.h"
+#include <atomic>
+#include <memory>
+#include <string>
+
+/* DECODED TEXTURE CACHE :
+ PNG decoding is the biggest part of a cold start. The cache directory keeps the decoded, GPU-ready
+ pixels of every texture as one blob per source file, named after a hash of the asset path:
+   TextureCacheHeader   (64 bytes) what the blob was built from and how
+   pixel data           the whole mip chain, exactly what LoadTextureFromImage() uploads
+ A warm start maps the blob and hands the mapped pixels to the GPU, no decoding at all.
+ The header carries a hash of the source bytes. A blob whose header does not match the source (size,
+ hash, options, format version) or that is truncated counts as stale and is rebuilt in place, so an
+ edited image replaces its blob instead of leaving the old one behind. Open() deletes blobs of older
+ format versions and temporary files left by an interrupted write.*/
+
+const unsigned int TEXCACHE_MAGIC = 0x43544753;   // "SGTC"
+const unsigned int TEXCACHE_VERSION = 2;
+
+// Build options. They are part of the blob header, so changing them rebuilds the cache.
+enum TextureCacheFlags {
+    TEXCACHE_PREMULTIPLY = 1 << 0,   // Store pixels with premultiplied alpha.
+    TEXCACHE_MIPMAPS = 1 << 1        // Store the full mip chain.
+};
+
+struct TextureCacheHeader {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int flags;
+    int width;
+    int height;
+    int mipmaps;
+    int format;
+    unsigned int dataSize;
+    unsigned long long sourceHash;
+    unsigned long long sourceSize;
+    unsigned long long decodeMicros;   // What building the blob cost, to report the time a hit saves.
+    unsigned char reserved[8];
+};
+static_assert(sizeof(TextureCacheHeader) == 64, "blob pixels must start 64-byte aligned");
+
+// Result of a cache lookup. On a hit 'image.data' points into 'mapping', which must stay open until the upload.
+struct CachedImage {
+    Image image = { 0 };
+    std::unique_ptr<MappedFile> mapping;
+};
+
+class TextureCache {
+public:
+    // Creates the directory if needed. Without a successful Open() every Load() is a plain decode.
+    bool Open(const char* directory, unsigned int buildFlags = 0);
+    bool IsOpen() const { return !dir.empty(); }
+
+    // Worker-thread safe. 'path' is the asset path (the blob name), 'source' the encoded file bytes.
+    void Load(const char* path, const unsigned char* source, int sourceSize, CachedImage& out);
+    // Frees the pixels of a CachedImage once they are uploaded.
+    static void Release(CachedImage& img);
+
+    static unsigned long long HashBytes(const unsigned char* data, size_t size);
+
+    int GetHits() const { return hits.load(); }
+    int GetMisses() const { return misses.load(); }
+    int GetRebuilt() const { return rebuilt.load(); }
+    double GetSavedMs() const { return savedMicros.load() / 1000.0; }
+
+private:
+    void PruneOldVersions();
+    bool ReadBlob(const char* path, unsigned long long hash, int sourceSize, CachedImage& out, unsigned long long* decodeMicros);
+    void WriteBlob(const char* path, const Image& image, unsigned long long hash, int sourceSize, unsigned long long decodeMicros);
+
+    std::string dir;
+    unsigned int flags = 0;
+    std::atomic<int> hits{ 0 };
+    std::atomic<int> misses{ 0 };
+    std::atomic<int> rebuilt{ 0 };              // Misses that replaced a stale blob.
+    std::atomic<long long> savedMicros{ 0 };
+};
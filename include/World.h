@@ -0,0 +1,201 @@
+﻿#pragma once
+#include "raylib.h"
+#include "raymath.h"
+#include "Enemy.h"
+#include "Tower.h"
+#include "Projectile.h"
+#include "EnemyGrid.h"
+#include "Level.h"
+#include "Particles.h"
+#include "DepthSort.h"
+#include "Renderer.h"
+#include "Rng.h"
+#include "StatusEffects.h"
+#include <vector>
+
+const int MAX_BLOOD = 100;
+const int COST_GANDALF = 40;
+const int COST_ROHIRRIM = 60;
+const int CASTLE_MAX_HEALTH = 100;
+
+// Save-state record of a rider (see Snapshot.h). All fields are 4 bytes wide, so there is no padding.
+struct RiderState {
+    Vector2 position; int pathIndex; int currentPoint; int active; float animTimer; int currentFrameIndex;
+};
+
+struct Rohirrim {
+    Vector2 position; std::vector<Vector2>* path; int currentPoint; bool active;
+    const std::vector<TextureRef>* frames; float animTimer; int currentFrameIndex;
+    Rohirrim(std::vector<Vector2>* p, const std::vector<TextureRef>* animFrames) {
+        path = p; frames = animFrames; currentPoint = (int)path->size() - 1; position = (*path)[currentPoint]; active = true; animTimer = 0.0f; currentFrameIndex = 0;
+    }
+    Rohirrim(const RiderState& s, std::vector<Vector2>* p, const std::vector<TextureRef>* animFrames) {
+        path = p; frames = animFrames; currentPoint = s.currentPoint; position = s.position; active = s.active != 0; animTimer = s.animTimer; currentFrameIndex = s.currentFrameIndex;
+    }
+    void Update(float dt) {
+        if (!active) return;
+        float speed = 350.0f; animTimer += dt;
+        if (animTimer >= 0.08f) { animTimer = 0.0f; currentFrameIndex++; if (currentFrameIndex >= frames->size()) currentFrameIndex = 0; }
+        if (currentPoint > 0) {
+            Vector2 target = (*path)[currentPoint - 1];
+            Vector2 dir = Vector2Normalize(Vector2Subtract(target, position));
+            position = Vector2Add(position, Vector2Scale(dir, speed * dt));
+            if (Vector2Distance(position, target) < 15.0f) currentPoint--;
+        }
+        else { active = false; }
+    }
+    void Draw() const {
+        if (!active || frames->empty()) return;
+        const Texture2D& currentTex = (*frames)[currentFrameIndex].Get();
+        Rectangle source = { 0, 0, (float)currentTex.width, (float)currentTex.height };
+        Rectangle dest = { position.x, position.y, 80, 80 }; Vector2 origin = { 40, 40 };
+        Renderer::DrawTexturePro(currentTex, source, dest, origin, 0.0f, WHITE);
+    }
+};
+
+enum class WorldOutcome { RUNNING, VICTORY, DEFEAT };
+
+/* WORLD :
+ The gameplay simulation of one level: entities, economy, castle and the wave cursor. It reads no input
+ and owns no window, so the same code runs inside the game loop and in the headless benchmark.
+ main.cpp turns input into calls on it (placing towers, abilities) and reacts to its outcome.
+ Enemies are removed swap-with-last, so their order in 'enemies' carries no meaning; anything that needs
+ an order (targeting, drawing) establishes it itself.*/
+class World {
+public:
+    // Clears everything and starts 'level' from its first wave. 'level' may be nullptr to just empty the world.
+    void Reset(LevelData* level, unsigned long long seed);
+    // Textures given to entities the World creates itself: spawned enemies and everything restored from a snapshot.
+    void SetEnemyTexture(EnemyType type, TextureHandle texture) { enemyTextures[(int)type] = texture; }
+    void SetTowerTextures(TowerType type, TextureHandle tower, TextureHandle projectile) {
+        towerTextures[(int)type] = tower; projectileTextures[(int)type] = projectile;
+    }
+    void SetRiderFrames(const std::vector<TextureRef>* frames) { riderFrames = frames; }
+    // Optional; the headless benchmark runs without particles.
+    void SetParticles(ParticleSystem* system) { particles = system; }
+
+    // One simulation step. Does nothing once the level is won or lost.
+    void Update(float dt);
+
+    /* TOWERS :
+     Building, upgrading and selling go through the World so the banner auras stay current. Buffs are
+     not recomputed every tick: a change only refreshes the towers within reach of the banner involved,
+     and only towers inside a banner's radius are looked at.*/
+    // Pays the build cost and places a tower. False if there is not enough gold.
+    bool BuildTower(Vector2 position, TowerType type);
+    // False if there is not enough gold.
+    bool UpgradeTower(int index);
+    // Removes the tower and refunds half the gold put into it. Returns the refund.
+    int SellTower(int index);
+
+    // Abilities. Return false if there is not enough Uruk blood.
+    bool CastGandalf();
+    bool CallRohirrim();
+
+    // Save states (Snapshot.h). SaveSnapshot() overwrites 'out' and reuses its capacity.
+    void SaveSnapshot(std::vector<unsigned char>& out) const;
+    // False, with the world untouched, if 'data' is not a valid snapshot of the current level.
+    bool LoadSnapshot(const unsigned char* data, size_t size);
+
+    // Draws towers, enemies, riders and projectiles that intersect 'view', depth sorted through 'list'.
+    void Draw(WorldRenderList& list, Rectangle view) const;
+
+    // Index into 'enemies' of the enemy 'handle' refers to, or -1 once that enemy has been removed.
+    int Resolve(EnemyHandle handle) const {
+        if (handle.slot < 0 || handle.slot >= (int)enemySlots.size()) return -1;
+        const EnemySlot& s = enemySlots[handle.slot];
+        return (s.generation == handle.generation) ? s.index : -1;
+    }
+
+    // Wave 'index' of the current run (generated for endless levels). False past the last wave.
+    bool PeekWave(int index, EnemyWave& out) const { return level && GetLevelWave(*level, waveSeed, index, out); }
+
+    const EnemyGrid& GetGrid() const { return grid; }
+    double GetLastUpdateMs() const { return lastUpdateMs; }
+    // Part of GetLastUpdateMs() spent ticking status effects.
+    double GetLastEffectsMs() const { return lastEffectsMs; }
+    // Heap memory held by the entity lists and the grid (capacity, not size), for the soak report.
+    size_t GetMemoryBytes() const;
+
+    LevelData* level = nullptr;
+    std::vector<Enemy> enemies;
+    std::vector<Tower> towers;
+    std::vector<Projectile> projectiles;
+    std::vector<Rohirrim> riders;
+
+    int gold = 0;
+    int urukBlood = 0;
+    int castleHealth = CASTLE_MAX_HEALTH;
+
+    unsigned long long waveSeed = 0;    // Seed given to Reset(); endless waves are generated from it.
+    int currentWaveIndex = 0;
+    EnemyWave currentWave = {};         // Copy of wave 'currentWaveIndex', valid while hasWave.
+    bool hasWave = false;
+    int enemiesSpawnedInWave = 0;
+    float spawnTimer = 0.0f;
+    float waveDelayTimer = 0.0f;
+    float walkSoundTimer = 0.0f;
+    bool isBossActive = false;
+    bool bossSpawned = false;       // Set during the Update() that spawned the boss.
+    bool castleInvulnerable = false;    // Leaks are only counted. Set by Reset() for horde levels; soak runs set it too.
+    WorldOutcome outcome = WorldOutcome::RUNNING;
+
+    // Living enemies per type, kept up to date on spawn and removal so the walk sounds need no scan.
+    int enemiesByType[(int)EnemyType::COUNT] = { 0 };
+    int totalSpawned = 0;
+    int totalKilled = 0;
+    int totalLeaked = 0;            // Enemies that reached the castle.
+    // Splash hits since Reset(), for the benchmark. Not part of save states.
+    int totalBlasts = 0;
+    int totalBlastHits = 0;
+    // Homing projectiles dropped because their target died or they ran out of time. Not part of save states.
+    int totalRetired = 0;
+    // Arrows, ice bolts and boulders fired, and how many of them hit (a boulder hits if its blast catches
+    // anyone). Not part of save states.
+    int totalShots = 0;
+    int totalShotHits = 0;
+    // Catapults throw at the intercept point (Tower::LeadTarget) instead of at the target. Off: it measured
+    // worse than plain aiming (see Tower::LeadTarget); the benchmark's --lead turns it on to compare.
+    bool leadTargeting = false;
+
+    Rng rng;
+    // Stun, slow, burn, poison, armor shred and fear on the enemies.
+    StatusEffects effects;
+
+private:
+    void UpdateWaves(float dt);
+    void SpawnEnemy(const EnemyWave& wave);
+    void UpdateWalkSounds(float dt);
+    void UpdateEnemies(float dt);
+    void UpdateRiders(float dt);
+    void UpdateProjectiles(float dt);
+    // Damages every living enemy within 'radius' of 'center' except 'skip' (the one hit directly, or -1).
+    // Returns how many were hit.
+    int Blast(Vector2 center, float radius, int damage, ProjectileType type, int skip);
+    void RemoveEnemy(size_t index);
+    void AddEnemyHandle(Enemy& enemy, int index);
+    void HitEnemy(Projectile& p, int index);
+    void AddBlood(int amount);
+    int PathIndexOf(const std::vector<Vector2>* path) const;
+    void RefreshBuff(Tower& tower);
+    void RefreshAround(Vector2 center, float radius);
+    void RebuildSupportList();
+    void ApplyEnemyAuras();
+
+    struct EnemySlot {
+        int index;                  // Into 'enemies', -1 while free.
+        unsigned int generation;
+    };
+    std::vector<EnemySlot> enemySlots;
+    std::vector<int> freeEnemySlots;
+
+    EnemyGrid grid;
+    ParticleSystem* particles = nullptr;
+    TextureHandle enemyTextures[(int)EnemyType::COUNT];
+    TextureHandle towerTextures[(int)TowerType::COUNT];
+    TextureHandle projectileTextures[(int)TowerType::COUNT];    // By the TowerType that fires them.
+    std::vector<int> supportTowers;         // Indices into 'towers' of the banners.
+    const std::vector<TextureRef>* riderFrames = nullptr;
+    double lastUpdateMs = 0.0;
+    double lastEffectsMs = 0.0;
+};
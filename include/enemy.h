@@ -1,28 +1,83 @@
 ﻿#pragma once
 #include "raylib.h"
 #include "raymath.h"
+#include "AssetRegistry.h"
 #include <vector>
 
 // An enum-type class that defines enemy variations within the game.
-enum class EnemyType { ORC, URUK, TROLL, GROND, COMMANDER, NAZGUL };
+enum class EnemyType { ORC, URUK, TROLL, GROND, COMMANDER, NAZGUL, COUNT };
+
+/* ENEMY HANDLE :
+ A reference to an enemy that survives the swap-with-last removals of World::enemies, for anything
+ that has to follow one enemy over several ticks (homing projectiles). 'slot' indexes the World's slot
+ table, which holds the enemy's current index; 'generation' is bumped whenever a slot is freed, so a
+ handle to a removed enemy stops resolving even after its slot is reused. See World::Resolve().*/
+struct EnemyHandle {
+    int slot = -1;
+    unsigned int generation = 0;
+};
+
+/* ENEMY STATUS :
+ What the status effects on an enemy add up to this tick. The effects themselves live in the World's
+ StatusEffects (StatusEffects.h), which rewrites this every tick; the enemy only reads it. Timers are
+ the seconds left, 0 when the effect is not active.*/
+struct EnemyStatus {
+    float stun = 0.0f;
+    float slow = 0.0f;
+    float slowFactor = 1.0f;        // Speed multiplier while slowed.
+    float fear = 0.0f;
+    float fearSpeed = 1.0f;         // Speed multiplier while fleeing back along the path.
+    float damageTakenScale = 1.0f;  // Armor shred.
+    bool burning = false;
+    bool poisoned = false;
+};
+
+// Everything that changes during an enemy's life, as a flat record for save states (see Snapshot.h).
+// All fields are 4 bytes wide, so the struct has no padding and is written as-is.
+struct EnemyState {
+    int type;
+    int pathIndex;          // Filled in by the World; the enemy only knows its path by pointer.
+    int currentPoint;
+    Vector2 position;
+    int alive;
+    int health;
+    int maxHealth;
+    float speed;
+    float distanceTraveled;
+    int manaReward;
+    int damage;
+    int currentFrame;
+    float animTimer;
+    int facing;
+    int handleSlot;
+    unsigned int handleGeneration;
+};
 
 class Enemy {
 public:
     
-    Enemy(EnemyType type, std::vector<Vector2>* path, Texture2D tex, float speedMult = 1.0f, int hpBonus = 0);
+    Enemy(EnemyType type, std::vector<Vector2>* path, TextureHandle tex, float speedMult = 1.0f, int hpBonus = 0);
+    // Restores a saved enemy; 'path' and 'tex' are the ones state.pathIndex and state.type refer to.
+    Enemy(const EnemyState& state, std::vector<Vector2>* path, TextureHandle tex);
 
     void Update(float dt);
     void Draw() const;
 
     void TakeDamage(int dmg);
 
-    // Status Effects: Managing mechanics that restrict the enemy's movement.
-    void ApplyStun(float duration);
-    void ApplySlow(float factor, float duration);
+    // Status effects are applied through World::effects; this is their combined result.
+    const EnemyStatus& GetStatus() const { return status; }
+    void SetStatus(const EnemyStatus& s) { status = s; }
+    EnemyStatus& EditStatus() { return status; }
+    // Bosses shrug off fear.
+    bool IsBoss() const { return type == EnemyType::GROND || type == EnemyType::NAZGUL; }
 
     bool IsAlive() const { return alive; }
     bool ReachedEnd() const { return currentPoint >= path->size() - 1; }
     Vector2 GetPosition() const { return position; }
+    // Where the enemy will be after 'seconds' if nothing new hits it: the current stun and slow run
+    // out on their own timers, and the distance covered is walked along the path (corners included).
+    Vector2 PredictPosition(float seconds) const;
 
     // Radius used for collision and turret range control. Returns 'Hitbox' size customized according to enemy type.
     float GetRadius() const {
@@ -31,16 +86,31 @@ public:
         if (type == EnemyType::TROLL) return 30.0f;
         return 15.0f;
     }
+    // Edge length of the sprite on screen. Also used to find the enemy's feet for depth sorting.
+    float GetDrawSize() const {
+        if (type == EnemyType::TROLL) return 64.0f;
+        if (type == EnemyType::GROND) return 100.0f;
+        if (type == EnemyType::NAZGUL) return 130.0f;
+        if (type == EnemyType::COMMANDER) return 60.0f;
+        return 48.0f;
+    }
     int GetManaReward() const { return manaReward; }
     int GetDamage() const { return damage; }
     int GetHealth() const { return health; }
     EnemyType GetType() const { return type; }
+    const std::vector<Vector2>* GetPath() const { return path; }
+    EnemyState GetState() const;
+    // Assigned by the World when the enemy joins its list.
+    EnemyHandle GetHandle() const { return handle; }
+    void SetHandle(EnemyHandle h) { handle = h; }
+    // Pixels walked along the path so far; the enemy with the highest value is the closest to the castle.
+    float GetDistanceTraveled() const { return distanceTraveled; }
 
 private:
     Vector2 position;
     std::vector<Vector2>* path;    // Reference to the vector holding the path coordinates.
     int currentPoint;    // The coordinates of the enemy's current advance.
-    Texture2D texture;
+    TextureRef texture;     // Keeps the sprite resident while the enemy exists.
     EnemyType type;
 
     bool alive;
@@ -50,10 +120,7 @@ private:
     float distanceTraveled;
 
     int manaReward;
-    float stunTimer;
-    float slowTimer;
-    float slowFactor;
-    bool frozen;
+    EnemyStatus status;
     int damage;
 
     int frameWidth;
@@ -61,4 +128,5 @@ private:
     int currentFrame;
     float animTimer;
     int facing;
+    EnemyHandle handle;
 };
@@ -2,37 +2,121 @@
 #include "raylib.h"
 #include "Enemy.h"
 #include "Projectile.h"
+#include "EnemyGrid.h"
+#include "StatusEffects.h"
 #include <vector>
 
 // Tower types: An enum-type class that specifies different damage, range, and special effects (slowness, etc.) for each type.
-enum class TowerType { ARCHER, MELEE, ICE };
+// BANNER is a support tower: it never attacks, its aura buffs the towers around it and slows the enemies.
+// CATAPULT lobs boulders that damage every enemy around the point they land on.
+// LIGHTNING strikes instantly and the bolt jumps on to the enemies nearest to the one it hit.
+enum class TowerType { ARCHER, MELEE, ICE, BANNER, CATAPULT, LIGHTNING, COUNT };
+
+// Blast radius of a boulder, and the radius an ice bolt shatters over (see World::Blast()).
+const float CATAPULT_SPLASH_RADIUS = 70.0f;
+const float ICE_SHATTER_RADIUS = 48.0f;
+// A lightning bolt jumps up to LIGHTNING_JUMPS times, each time at most LIGHTNING_JUMP_RADIUS away,
+// and every jump keeps LIGHTNING_FALLOFF of the damage of the one before.
+const int LIGHTNING_JUMPS = 4;
+const float LIGHTNING_JUMP_RADIUS = 120.0f;
+const float LIGHTNING_FALLOFF = 0.75f;
+// A banner stops upgrading here: its aura then slows enemies by MAX_AURA_SLOW, half their speed.
+const int BANNER_MAX_LEVEL = 8;
+const float MAX_AURA_SLOW = 0.5f;
+
+// Save-state record of a tower (see Snapshot.h). All fields are 4 bytes wide, so there is no padding.
+// Stats are the unbuffed ones; buffs are recomputed from the banners after loading.
+struct TowerState {
+    Vector2 position;
+    int type;
+    int level;
+    float cooldown;
+    float range;
+    int damage;
+    float fireRate;
+    int cost;
+    int spent;
+};
+
+// What a support tower's aura gives the towers inside 'radius', as fractions (0.2 = +20%), and takes
+// from the enemies inside it.
+struct TowerAura {
+    float radius;
+    float rateBonus;
+    float rangeBonus;
+    float damageBonus;
+    float enemySlow;        // Fraction of speed taken away, applied as a SLOW status effect.
+};
+
+// Bonuses a tower currently receives. Auras do not stack: each bonus is the best one among the
+// banners covering the tower.
+struct TowerBuff {
+    float rate = 0.0f;
+    float range = 0.0f;
+    float damage = 0.0f;
+};
 
 class Tower {
 public:
 
     // When building the tower, importing the bullet texture (projTex) from an external source allows for efficient memory usage instead of reloading the texture with each shot.
-    Tower(Vector2 pos, Texture2D tex, Texture2D projTex, TowerType type);
+    Tower(Vector2 pos, TextureHandle tex, TextureHandle projTex, TowerType type);
+    Tower(const TowerState& state, TextureHandle tex, TextureHandle projTex);
 
-    void Update(float dt, std::vector<Enemy>& enemies, std::vector<Projectile>& projectiles);
+    // 'leadTargeting' throws boulders at the intercept point (LeadTarget) instead of at the target; homing
+    // arrows and ice bolts steer onto it either way. Effects the tower inflicts directly (lightning's armor
+    // shred) go to 'effects'.
+    void Update(float dt, std::vector<Enemy>& enemies, const EnemyGrid& grid, std::vector<Projectile>& projectiles, StatusEffects& effects,
+        bool leadTargeting = false);
     void Draw() const;
     void Upgrade();
 
+    static int GetBuildCost(TowerType type);
+    // Range of a freshly built tower; for a banner, the radius of its aura.
+    static float GetBaseRange(TowerType type);
+    // Point where a projectile fired from 'from' at 'projectileSpeed' meets 'enemy', predicted along its path.
+    static Vector2 LeadTarget(const Enemy& enemy, Vector2 from, float projectileSpeed);
+    // Enemies struck by a bolt that hits 'first' and jumps up to 'jumps' times, each time to the nearest
+    // living enemy not struck yet within 'jumpRadius' (EnemyGrid::FindNearest). Writes them to 'out'
+    // (room for jumps + 1) in strike order and returns how many there are.
+    static int FindChain(const std::vector<Enemy>& enemies, const EnemyGrid& grid, int first, int jumps, float jumpRadius, int* out);
+
+    bool IsSupport() const { return type == TowerType::BANNER; }
+    // Zero radius for towers that are not supports.
+    TowerAura GetAura() const;
+    // Sets the bonuses and recomputes the effective range, damage and fire rate from the base ones.
+    void SetBuff(const TowerBuff& newBuff);
+    const TowerBuff& GetBuff() const { return buff; }
+    // Gold put into this tower (build + upgrades); selling refunds half of it.
+    void AddSpent(int gold) { spent += gold; }
+    int GetSpent() const { return spent; }
+
     bool IsClicked(Vector2 mousePos) const;
     Vector2 GetPosition() const { return position; }
     // A simple formula where the cost increases exponentially as the level rises.
     int GetUpgradeCost() const { return cost * 2; }
+    bool CanUpgrade() const { return !IsSupport() || level < BANNER_MAX_LEVEL; }
     float GetRange() const { return range; }
+    TowerType GetType() const { return type; }
+    TowerState GetState() const;
 
 private:
     Vector2 position;
-    Texture2D texture;
-    Texture2D projTexture; 
+    TextureRef texture;
+    TextureRef projTexture;
     TowerType type;
 
     int level;
     float cooldown;
+    // Effective stats, i.e. base stats with 'buff' applied. Update() only reads these.
     float range;
     int damage;
     float fireRate;
     int cost;
+    int spent;
+
+    float baseRange;
+    int baseDamage;
+    float baseFireRate;
+    TowerBuff buff;
 };
@@ -0,0 +1,187 @@
+﻿#include "AssetArchive.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::Open(const char* path) {
+    Close();
+#ifdef _WIN32
+    HANDLE fh = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fh == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fh, &fileSize) || fileSize.QuadPart == 0) { CloseHandle(fh); return false; }
+    HANDLE mh = CreateFileMappingA(fh, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mh == nullptr) { CloseHandle(fh); return false; }
+    void* view = MapViewOfFile(mh, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) { CloseHandle(mh); CloseHandle(fh); return false; }
+    fileHandle = fh; mappingHandle = mh;
+    data = (const unsigned char*)view;
+    size = (size_t)fileSize.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);   // The mapping keeps the file referenced.
+    if (view == MAP_FAILED) return false;
+    data = (const unsigned char*)view;
+    size = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mappingHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mappingHandle = nullptr; fileHandle = nullptr;
+#else
+    munmap((void*)data, size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+// FNV-1a with '\\' folded to '/', so Windows-style paths find the same entry.
+unsigned long long AssetArchive::HashPath(const char* path) {
+    unsigned long long h = 14695981039346656037ULL;
+    for (const unsigned char* p = (const unsigned char*)path; *p; p++) {
+        unsigned char c = (*p == '\\') ? '/' : *p;
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static bool SamePath(const char* a, const char* b, unsigned int lengthB) {
+    for (unsigned int i = 0; i < lengthB; i++, a++) {
+        char ca = (*a == '\\') ? '/' : *a;
+        if (ca == '\0' || ca != b[i]) return false;
+    }
+    return *a == '\0';
+}
+
+/* OPENING :
+ One open + one mmap for the whole asset set. The header and index are validated against the
+ mapping size once; after that every lookup is pointer arithmetic inside the mapping.*/
+bool AssetArchive::Open(const char* path) {
+    Close();
+    if (!file.Open(path)) return false;
+
+    if (file.Size() < sizeof(ArchiveHeader)) { Close(); return false; }
+    header = (const ArchiveHeader*)file.Data();
+    if (header->magic != ARCHIVE_MAGIC || header->version != ARCHIVE_VERSION) { Close(); return false; }
+
+    size_t indexEnd = sizeof(ArchiveHeader) + (size_t)header->entryCount * sizeof(ArchiveEntry);
+    if (indexEnd > file.Size() || header->stringTableOffset < indexEnd || header->stringTableOffset > file.Size()) { Close(); return false; }
+    entries = (const ArchiveEntry*)(file.Data() + sizeof(ArchiveHeader));
+    strings = (const char*)(file.Data() + header->stringTableOffset);
+
+    for (unsigned int i = 0; i < header->entryCount; i++) {
+        const ArchiveEntry& e = entries[i];
+        if (e.dataOffset + e.dataSize > file.Size() || header->stringTableOffset + (size_t)e.pathOffset + e.pathLength > file.Size()) { Close(); return false; }
+    }
+    return true;
+}
+
+void AssetArchive::Close() {
+    file.Close();
+    header = nullptr;
+    entries = nullptr;
+    strings = nullptr;
+}
+
+const unsigned char* AssetArchive::Find(const char* path, int* size) const {
+    if (!header) return nullptr;
+    unsigned long long hash = HashPath(path);
+
+    const ArchiveEntry* first = entries;
+    const ArchiveEntry* last = entries + header->entryCount;
+    const ArchiveEntry* it = std::lower_bound(first, last, hash, [](const ArchiveEntry& e, unsigned long long h) { return e.pathHash < h; });
+    for (; it != last && it->pathHash == hash; ++it) {
+        if (SamePath(path, strings + it->pathOffset, it->pathLength)) {
+            if (size) *size = (int)it->dataSize;
+            return file.Data() + it->dataOffset;
+        }
+    }
+    return nullptr;
+}
+
+static bool ReadWholeFile(const char* path, std::vector<unsigned char>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    out.resize(length > 0 ? (size_t)length : 0);
+    size_t got = out.empty() ? 0 : fread(out.data(), 1, out.size(), f);
+    fclose(f);
+    return got == out.size();
+}
+
+bool AssetArchive::Write(const char* outPath, const std::vector<std::string>& archivePaths, const std::vector<std::string>& diskPaths) {
+    if (archivePaths.size() != diskPaths.size()) return false;
+    size_t count = archivePaths.size();
+
+    // Entries are sorted by hash for the binary search in Find().
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return HashPath(archivePaths[a].c_str()) < HashPath(archivePaths[b].c_str()); });
+
+    std::vector<ArchiveEntry> entries(count);
+    std::string stringTable;
+    for (size_t i = 0; i < count; i++) {
+        std::string path = archivePaths[order[i]];
+        std::replace(path.begin(), path.end(), '\\', '/');
+        entries[i].pathHash = HashPath(path.c_str());
+        entries[i].pathOffset = (unsigned int)stringTable.size();
+        entries[i].pathLength = (unsigned int)path.size();
+        stringTable += path;
+    }
+
+    ArchiveHeader header = { ARCHIVE_MAGIC, ARCHIVE_VERSION, (unsigned int)count, 0 };
+    header.stringTableOffset = (unsigned int)(sizeof(ArchiveHeader) + count * sizeof(ArchiveEntry));
+
+    unsigned long long offset = header.stringTableOffset + stringTable.size();
+    std::vector<std::vector<unsigned char>> blobs(count);
+    for (size_t i = 0; i < count; i++) {
+        if (!ReadWholeFile(diskPaths[order[i]].c_str(), blobs[i])) {
+            fprintf(stderr, "pack: cannot read %s\n", diskPaths[order[i]].c_str());
+            return false;
+        }
+        offset = (offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+        entries[i].dataOffset = offset;
+        entries[i].dataSize = blobs[i].size();
+        offset += blobs[i].size();
+    }
+
+    FILE* f = fopen(outPath, "wb");
+    if (!f) return false;
+    fwrite(&header, sizeof(header), 1, f);
+    if (count > 0) fwrite(entries.data(), sizeof(ArchiveEntry), count, f);
+    fwrite(stringTable.data(), 1, stringTable.size(), f);
+    unsigned long long written = header.stringTableOffset + stringTable.size();
+    static const unsigned char zeros[ARCHIVE_ALIGNMENT] = { 0 };
+    for (size_t i = 0; i < count; i++) {
+        fwrite(zeros, 1, (size_t)(entries[i].dataOffset - written), f);
+        if (!blobs[i].empty()) fwrite(blobs[i].data(), 1, blobs[i].size(), f);
+        written = entries[i].dataOffset + blobs[i].size();
+    }
+    bool ok = (ferror(f) == 0);
+    fclose(f);
+    return ok;
+}
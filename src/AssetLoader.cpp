@@ -0,0 +1,137 @@
+﻿#include "AssetLoader.h"
+#include "Audio.h"
+#include <chrono>
+
+static double NowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+AssetLoader::~AssetLoader() {
+    for (std::thread& t : workers) if (t.joinable()) t.join();
+}
+
+void AssetLoader::QueueTexture(Texture2D* target, const char* path) {
+    Job job = { AssetKind::TEXTURE, "", path, target };
+    jobs.push_back(std::move(job));
+}
+
+void AssetLoader::QueueSound(const char* name, const char* path) {
+    Job job = { AssetKind::SOUND, name, path, nullptr };
+    jobs.push_back(std::move(job));
+}
+
+void AssetLoader::QueueMusic(const char* name, const char* path) {
+    Job job = { AssetKind::MUSIC, name, path, nullptr };
+    jobs.push_back(std::move(job));
+}
+
+void AssetLoader::Start(int workerCount) {
+    if (workerCount <= 0) {
+        int cores = (int)std::thread::hardware_concurrency();
+        workerCount = (cores > 1) ? cores - 1 : 1;
+        if (workerCount > 4) workerCount = 4;
+    }
+    for (int i = 0; i < workerCount; i++) workers.emplace_back(&AssetLoader::WorkerMain, this);
+}
+
+/* WORKER LOOP :
+ Jobs are claimed with an atomic counter, so no lock is held while a file is being decoded.
+ Only the hand-off of a finished job index to the main thread goes through the mutex.*/
+void AssetLoader::WorkerMain() {
+    while (true) {
+        int index = nextJob.fetch_add(1);
+        if (index >= (int)jobs.size()) return;
+
+        double start = NowMs();
+        Decode(jobs[index]);
+        decodeMs += (long long)((NowMs() - start) * 1000.0);
+
+        std::lock_guard<std::mutex> lock(readyMutex);
+        ready.push_back(index);
+        decoded++;
+    }
+}
+
+void AssetLoader::Decode(Job& job) {
+    /* ARCHIVE PATH :
+     The decoders get a pointer into the memory-mapped archive, so the bytes are read from the page
+     cache directly instead of being copied into a heap buffer first. Music streams keep pointing into
+     the mapping for as long as they play.*/
+    int size = 0;
+    const unsigned char* packed = archive ? archive->Find(job.path.c_str(), &size) : nullptr;
+    const char* ext = GetFileExtension(job.path.c_str());
+    if (job.kind == AssetKind::TEXTURE) {
+        if (!textureCache) {
+            job.image.image = packed ? LoadImageFromMemory(ext, packed, size) : LoadImage(job.path.c_str());
+            return;
+        }
+        // The cache checks the encoded bytes against the blob, so a loose file is read whole first.
+        if (packed) textureCache->Load(job.path.c_str(), packed, size, job.image);
+        else {
+            unsigned char* bytes = LoadFileData(job.path.c_str(), &size);
+            if (bytes) textureCache->Load(job.path.c_str(), bytes, size, job.image);
+            UnloadFileData(bytes);
+        }
+        return;
+    }
+
+    if (packed) {
+        if (job.kind == AssetKind::SOUND) job.wave = LoadWaveFromMemory(ext, packed, size);
+        else { job.fileData = (unsigned char*)packed; job.fileSize = size; job.fileDataMapped = true; }
+        return;
+    }
+
+    if (job.kind == AssetKind::SOUND) job.wave = LoadWave(job.path.c_str());
+    // Music is streamed, so only the file bytes are read here; the decoder pulls from them during playback.
+    else job.fileData = LoadFileData(job.path.c_str(), &job.fileSize);
+}
+
+void AssetLoader::Upload(Job& job) {
+    if (job.kind == AssetKind::TEXTURE) {
+        if (job.image.image.data != nullptr) *job.target = LoadTextureFromImage(job.image.image);
+        TextureCache::Release(job.image);
+    }
+    else if (job.kind == AssetKind::SOUND) {
+        Audio::LoadSFXFromWave(job.name, job.wave);     // Audio frees the wave once its thread has made the sound.
+        job.wave = { 0 };
+    }
+    else {
+        // Audio takes ownership of loose-file bytes, they must outlive the stream. Mapped bytes belong to the archive.
+        Audio::LoadMusicFromMemory(job.name, GetFileExtension(job.path.c_str()), job.fileData, job.fileSize, !job.fileDataMapped);
+        job.fileData = nullptr;
+    }
+}
+
+int AssetLoader::UploadPending(double budgetMs) {
+    double start = NowMs();
+    int count = 0;
+    while (true) {
+        int index = -1;
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            if (ready.empty()) break;
+            index = ready.back();
+            ready.pop_back();
+        }
+        Upload(jobs[index]);
+        uploaded++;
+        count++;
+        if (NowMs() - start >= budgetMs) break;
+    }
+    return count;
+}
+
+// Blocks until every job is decoded and uploaded; used when there is no frame to keep alive.
+void AssetLoader::Finish() {
+    while (!IsDone()) {
+        if (UploadPending(1000.0) == 0) std::this_thread::yield();
+    }
+    for (std::thread& t : workers) if (t.joinable()) t.join();
+    workers.clear();
+}
+
+float AssetLoader::GetProgress() const {
+    if (jobs.empty()) return 1.0f;
+    return (decoded.load() + uploaded) / (2.0f * jobs.size());
+}
@@ -0,0 +1,164 @@
+﻿#include "AssetRegistry.h"
+#include "Audio.h"
+
+std::deque<AssetRegistry::Slot> AssetRegistry::slots;
+unsigned int AssetRegistry::generation = 1;
+unsigned long long AssetRegistry::frame = 1;
+size_t AssetRegistry::vramBudget = 0;
+size_t AssetRegistry::ramBudget = 0;
+bool AssetRegistry::ramWarned = false;
+int AssetRegistry::evictions = 0;
+int AssetRegistry::reloads = 0;
+const AssetArchive* AssetRegistry::archive = nullptr;
+TextureCache* AssetRegistry::textureCache = nullptr;
+
+static const char* ClassName(AssetClass cls) {
+    static const char* names[] = { "ui", "enemy", "tower", "projectile", "effect", "environment", "sound", "music" };
+    return names[(int)cls];
+}
+
+static size_t TextureBytes(const Texture2D& tex) {
+    if (tex.id == 0) return 0;
+    size_t total = 0;
+    int w = tex.width, h = tex.height;
+    for (int i = 0; i < tex.mipmaps; i++) {
+        total += (size_t)GetPixelDataSize(w, h, tex.format);
+        w = (w > 1) ? w / 2 : 1;
+        h = (h > 1) ? h / 2 : 1;
+    }
+    return total;
+}
+
+TextureHandle AssetRegistry::RegisterTexture(const char* path, AssetClass cls) {
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (slots[i].path == path) return { (unsigned int)i, generation };
+    }
+    slots.push_back({ path, cls, { 0 }, 0, 0, false });
+    return { (unsigned int)(slots.size() - 1), generation };
+}
+
+AssetRegistry::Slot* AssetRegistry::Resolve(TextureHandle handle) {
+    if (handle.generation != generation || handle.index >= slots.size()) return nullptr;
+    return &slots[handle.index];
+}
+
+Texture2D* AssetRegistry::GetLoadTarget(TextureHandle handle) {
+    Slot* slot = Resolve(handle);
+    return slot ? &slot->texture : nullptr;
+}
+
+const Texture2D& AssetRegistry::Get(TextureHandle handle) {
+    static const Texture2D none = { 0 };
+    Slot* slot = Resolve(handle);
+    if (!slot) return none;
+    if (slot->evicted) Reload(*slot);
+    slot->lastUsedFrame = frame;
+    return slot->texture;
+}
+
+void AssetRegistry::AddRef(TextureHandle handle) {
+    if (Slot* slot = Resolve(handle)) slot->refCount++;
+}
+
+void AssetRegistry::Release(TextureHandle handle) {
+    if (Slot* slot = Resolve(handle)) slot->refCount--;
+}
+
+int AssetRegistry::GetRefCount(TextureHandle handle) {
+    Slot* slot = Resolve(handle);
+    return slot ? slot->refCount : 0;
+}
+
+void AssetRegistry::SetSources(const AssetArchive* pak, TextureCache* cache) {
+    archive = pak;
+    textureCache = cache;
+}
+
+void AssetRegistry::SetBudget(size_t vramBytes, size_t ramBytes) {
+    vramBudget = vramBytes;
+    ramBudget = ramBytes;
+    ramWarned = false;
+}
+
+// Same sources and order as AssetLoader::Decode(), but on the calling thread.
+void AssetRegistry::Reload(Slot& slot) {
+    const char* ext = GetFileExtension(slot.path.c_str());
+    int size = 0;
+    const unsigned char* packed = archive ? archive->Find(slot.path.c_str(), &size) : nullptr;
+    unsigned char* bytes = packed ? nullptr : LoadFileData(slot.path.c_str(), &size);
+    const unsigned char* source = packed ? packed : bytes;
+
+    CachedImage img;
+    if (source && textureCache) textureCache->Load(slot.path.c_str(), source, size, img);
+    else if (source) img.image = LoadImageFromMemory(ext, source, size);
+    UnloadFileData(bytes);
+
+    if (img.image.data != nullptr) slot.texture = LoadTextureFromImage(img.image);
+    TextureCache::Release(img);
+    slot.evicted = false;
+    reloads++;
+    TraceLog(LOG_INFO, "ASSETS: reloaded evicted texture %s", slot.path.c_str());
+}
+
+/* BUDGET ENFORCEMENT :
+ Only textures nobody holds a TextureRef to and that were not drawn this frame are candidates.
+ They are evicted oldest-use first until the resident total fits the budget again. With a few
+ dozen textures a linear scan per eviction is cheaper than keeping an LRU list up to date on every Get().*/
+void AssetRegistry::Update() {
+    if (vramBudget > 0) {
+        size_t resident = GetVramBytes();
+        while (resident > vramBudget) {
+            Slot* victim = nullptr;
+            for (Slot& slot : slots) {
+                if (slot.refCount > 0 || slot.texture.id == 0 || slot.lastUsedFrame == frame) continue;
+                if (!victim || slot.lastUsedFrame < victim->lastUsedFrame) victim = &slot;
+            }
+            if (!victim) break;
+            resident -= TextureBytes(victim->texture);
+            UnloadTexture(victim->texture);
+            victim->texture = { 0 };
+            victim->evicted = true;
+            evictions++;
+        }
+    }
+
+    if (ramBudget > 0 && !ramWarned) {
+        size_t ram = GetBytes(AssetClass::SOUND) + GetBytes(AssetClass::MUSIC);
+        if (ram > ramBudget) {
+            TraceLog(LOG_WARNING, "ASSETS: audio uses %.1f MB, over the %.1f MB RAM budget", ram / (1024.0 * 1024.0), ramBudget / (1024.0 * 1024.0));
+            ramWarned = true;
+        }
+    }
+    frame++;
+}
+
+size_t AssetRegistry::GetBytes(AssetClass cls) {
+    if (cls == AssetClass::SOUND) return Audio::GetSoundBytes();
+    if (cls == AssetClass::MUSIC) return Audio::GetMusicBytes();
+    size_t total = 0;
+    for (const Slot& slot : slots) if (slot.cls == cls) total += TextureBytes(slot.texture);
+    return total;
+}
+
+size_t AssetRegistry::GetVramBytes() {
+    size_t total = 0;
+    for (const Slot& slot : slots) total += TextureBytes(slot.texture);
+    return total;
+}
+
+void AssetRegistry::LogReport() {
+    TraceLog(LOG_INFO, "ASSETS: memory by class (%d textures registered, %d evictions, %d reloads)", (int)slots.size(), evictions, reloads);
+    for (int i = 0; i < (int)AssetClass::COUNT; i++) {
+        size_t bytes = GetBytes((AssetClass)i);
+        TraceLog(LOG_INFO, "ASSETS:   %-12s %8.1f KB%s", ClassName((AssetClass)i), bytes / 1024.0, (i >= (int)AssetClass::SOUND) ? " (RAM)" : " (VRAM)");
+    }
+}
+
+void AssetRegistry::Clear() {
+    for (Slot& slot : slots) {
+        if (slot.texture.id > 0) UnloadTexture(slot.texture);
+        if (slot.refCount != 0) TraceLog(LOG_WARNING, "ASSETS: %s still has %d references at unload", slot.path.c_str(), slot.refCount);
+    }
+    slots.clear();
+    generation++;
+}
@@ -1,81 +1,600 @@
 ﻿#include "Audio.h"
 
 
-std::map<std::string, Sound> Audio::sounds;
-std::map<std::string, Music> Audio::musics;
-Music* Audio::currentMusic = nullptr;
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+// Same order as SoundId / MusicId in Audio.h.
+static const char* SFX_NAMES[] = {
+    "arrow_shoot", "ice_shoot", "arrow_hit", "ice_hit", "magic_shoot", "sword_hit", "orc_death", "build_tower",
+    "ui_click", "gold_gain", "spawn_1", "spawn_2", "spawn_3", "gandalf", "rohirrim", "victory", "orc_walk", "heavy_walk"
+};
+static const char* MUSIC_NAMES[] = {
+    "music_menu", "music_level1", "music_level2", "music_level3", "music_boss", "game_over", "victory_jingle"
+};
+static_assert(sizeof(SFX_NAMES) / sizeof(SFX_NAMES[0]) == (size_t)SoundId::COUNT, "SFX_NAMES must match SoundId");
+static_assert(sizeof(MUSIC_NAMES) / sizeof(MUSIC_NAMES[0]) == (size_t)MusicId::COUNT, "MUSIC_NAMES must match MusicId");
+
+std::unordered_map<std::string, int> Audio::soundIds;
+std::unordered_map<std::string, int> Audio::musicIds;
+std::vector<Audio::SfxRequest> Audio::pending;
+std::vector<int> Audio::pendingIndex;
+std::vector<int> Audio::sfxPriority;
+Vector2 Audio::listenerPos = { 0.0f, 0.0f };
+float Audio::hearingRadius = 0.0f;
+int Audio::sfxBudget = 8;
+int Audio::requestedMusic = -1;
+int Audio::requestedPrefetch = -1;
+float Audio::requestedVolume = -1.0f;
+
+std::vector<Audio::SfxEntry> Audio::sounds;
+std::vector<Audio::MusicEntry> Audio::musics;
+int Audio::currentMusic = -1;
+int Audio::fadingMusic = -1;
+int Audio::prefetchedMusic = -1;
+float Audio::musicVolume = 0.5f;
+float Audio::fadingVolume = 0.0f;
+float Audio::fadeElapsed = 0.0f;
+float Audio::fadeDuration = 0.0f;
+
+SpscRing<Audio::Command, 1024> Audio::commands;
+std::thread Audio::thread;
+std::atomic<int> Audio::activeVoices{ 0 };
+std::atomic<size_t> Audio::soundBytes{ 0 };
+std::atomic<size_t> Audio::musicBytes{ 0 };
+std::atomic<int> Audio::statRequests{ 0 }, Audio::statCoalesced{ 0 }, Audio::statStarted{ 0 }, Audio::statStolen{ 0 }, Audio::statRestarted{ 0 }, Audio::statDropped{ 0 };
+std::atomic<int> Audio::statCulled{ 0 }, Audio::statOverBudget{ 0 };
+
+// How often the audio thread wakes up to apply commands and refill the music stream.
+static const int AUDIO_THREAD_PERIOD_MS = 2;
+
+// Every sound starts with this many voices and normal priority; SetSFXLimits() changes both.
+static const int DEFAULT_SFX_VOICES = 4;
+static const int DEFAULT_SFX_PRIORITY = 1;
+
+// Positional sounds quieter than this after attenuation are not worth a voice.
+static const float SFX_AUDIBLE_VOLUME = 0.01f;
+// How far a sound at the edge of hearing is panned (raylib 5.5: 0.5 is center, 1.0 full left).
+static const float SFX_MAX_PAN = 0.3f;
+
+// Volume a track starts at, before the game sets its own.
+static const float DEFAULT_MUSIC_VOLUME = 0.5f;
+
+/* MUSIC STREAM BUFFER :
+ Raylib's default stream buffer holds a few tens of milliseconds. Music streams get 8192 frames
+ (~0.19 s at 44.1 kHz) per half-buffer instead, so the decoder runs in larger, rarer chunks and a
+ stalled audio thread has that much headroom before the music breaks up.*/
+static const int MUSIC_STREAM_BUFFER_FRAMES = 8192;
+
+static double NowSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
 
 void Audio::Init() {
     InitAudioDevice(); 
+    for (const char* name : SFX_NAMES) InternSound(name);
+    for (const char* name : MUSIC_NAMES) InternMusic(name);
+    thread = std::thread(&Audio::ThreadMain);
 }
 /* RESOURCE CLEANUP :
- Iterates through all loaded sounds and music streams to unload them from memory
- before closing the audio device. This prevents memory leaks upon game exit.*/
+ The audio thread unloads all sounds and music streams itself when it receives QUIT, since it owns
+ them; only then is the audio device closed. This prevents memory leaks upon game exit.*/
 void Audio::Close() {
-    
-    for (auto& pair : sounds) UnloadSound(pair.second);
-    for (auto& pair : musics) UnloadMusicStream(pair.second);
-    sounds.clear();
-    musics.clear();
+    if (thread.joinable()) {
+        Send(MakeCommand(CommandType::QUIT, -1));
+        thread.join();
+    }
+    soundIds.clear();
+    musicIds.clear();
+    pending.clear();
+    pendingIndex.clear();
+    sfxPriority.clear();
+    requestedMusic = -1;
+    requestedPrefetch = -1;
+    requestedVolume = -1.0f;
     CloseAudioDevice();
 }
 
-/* MUSIC STREAMING UPDATE :
- Raylib's music system requires this function to be called every frame.
- It refills the audio buffer; without this, music would play for a fraction of a second and stop.*/
+/* ---------------------------------------------------------------- game thread */
+
+Audio::Command Audio::MakeCommand(CommandType type, int id) {
+    Command cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.type = type;
+    cmd.id = id;
+    return cmd;
+}
+
+// Sound effects are the only commands that may be dropped; everything else waits for a free slot.
+void Audio::Send(const Command& cmd) {
+    while (!commands.Push(cmd)) {
+        if (cmd.type == CommandType::PLAY_SFX) { statDropped++; return; }
+        std::this_thread::yield();
+    }
+}
+
+/* FRAME BUDGET :
+ Hands this frame's merged sound effect requests to the audio thread. When more different sounds were
+ requested than the budget allows, the most important (priority, then loudness after attenuation) are
+ kept and the rest are dropped here, before they cost a command or a voice.*/
 void Audio::Update() {
-    if (currentMusic != nullptr) {
-        UpdateMusicStream(*currentMusic);
+    if (sfxBudget > 0 && (int)pending.size() > sfxBudget) {
+        std::partial_sort(pending.begin(), pending.begin() + sfxBudget, pending.end(), [](const SfxRequest& a, const SfxRequest& b) {
+            if (sfxPriority[a.id] != sfxPriority[b.id]) return sfxPriority[a.id] > sfxPriority[b.id];
+            return a.volume > b.volume;
+        });
+        for (size_t i = sfxBudget; i < pending.size(); i++) {
+            statOverBudget += pending[i].count;
+            pendingIndex[pending[i].id] = -1;
+        }
+        pending.resize(sfxBudget);
     }
+    for (const SfxRequest& req : pending) {
+        Command cmd = MakeCommand(CommandType::PLAY_SFX, req.id);
+        cmd.volume = req.volume;
+        cmd.pitch = req.pitch;
+        cmd.pan = req.pan;
+        cmd.count = req.count;
+        Send(cmd);
+        pendingIndex[req.id] = -1;
+    }
+    pending.clear();
+}
+
+int Audio::InternSound(const std::string& name) {
+    auto it = soundIds.find(name);
+    if (it != soundIds.end()) return it->second;
+    int id = (int)pendingIndex.size();
+    pendingIndex.push_back(-1);
+    sfxPriority.push_back(DEFAULT_SFX_PRIORITY);
+    soundIds[name] = id;
+    return id;
+}
+
+int Audio::InternMusic(const std::string& name) {
+    auto it = musicIds.find(name);
+    if (it != musicIds.end()) return it->second;
+    int id = (int)musicIds.size();
+    musicIds[name] = id;
+    return id;
+}
+
+void Audio::LoadSFX(const std::string& name, const char* path) {
+    LoadSFXFromWave(name, LoadWave(path));
 }
 
-void Audio::LoadSFX(std::string name, const char* path) {
-    Sound snd = LoadSound(path);
-    sounds[name] = snd;
+void Audio::LoadMusic(const std::string& name, const char* path) {
+    int size = 0;
+    unsigned char* data = LoadFileData(path, &size);
+    LoadMusicFromMemory(name, GetFileExtension(path), data, size, true);
 }
 
-void Audio::LoadMusic(std::string name, const char* path) {
-    Music mus = LoadMusicStream(path);
-    mus.looping = true;
-    musics[name] = mus;
+void Audio::LoadSFXFromWave(const std::string& name, Wave wave) {
+    if (wave.data == nullptr) return;
+    Command cmd = MakeCommand(CommandType::LOAD_SFX, InternSound(name));
+    cmd.wave = wave;
+    Send(cmd);
 }
 
-void Audio::PlaySFX(std::string name, float volume, float pitch) {
-    if (sounds.find(name) != sounds.end()) {
-        /* SFX PLAYBACK WITH MODIFIERS :
-         Sets specific volume and pitch (speed) for the sound effect instance before playing it.
-         This allows for variation (e.g., random pitch for footsteps) using a single asset
-         to reduce auditory repetition.*/
-        SetSoundVolume(sounds[name], volume); 
-        SetSoundPitch(sounds[name], pitch);  
-        PlaySound(sounds[name]);
+void Audio::LoadMusicFromMemory(const std::string& name, const char* fileType, unsigned char* data, int dataSize, bool takeOwnership) {
+    if (data == nullptr) return;
+    Command cmd = MakeCommand(CommandType::LOAD_MUSIC, InternMusic(name));
+    cmd.data = data;
+    cmd.dataSize = dataSize;
+    cmd.takeOwnership = takeOwnership;
+    strncpy(cmd.fileType, fileType, sizeof(cmd.fileType) - 1);
+    Send(cmd);
+}
+
+void Audio::SetSFXLimits(SoundId id, int maxVoices, int priority) {
+    Command cmd = MakeCommand(CommandType::SET_SFX_LIMITS, (int)id);
+    cmd.count = (maxVoices < 1) ? 1 : maxVoices;
+    cmd.priority = priority;
+    Send(cmd);
+    if ((int)id >= 0 && (int)id < (int)sfxPriority.size()) sfxPriority[(int)id] = priority;
+}
+
+void Audio::SetListener(Vector2 center, float radius) {
+    listenerPos = center;
+    hearingRadius = radius;
+}
+
+void Audio::SetSFXBudget(int maxPerFrame) {
+    sfxBudget = maxPerFrame;
+}
+
+void Audio::UnloadMusic(const std::string& name) {
+    auto it = musicIds.find(name);
+    if (it == musicIds.end()) return;
+    if (requestedMusic == it->second) requestedMusic = -1;
+    if (requestedPrefetch == it->second) requestedPrefetch = -1;
+    Send(MakeCommand(CommandType::UNLOAD_MUSIC, it->second));
+}
+
+/* SFX REQUESTS :
+ PlaySFX() only records the request. A request for a sound that was already requested this frame is
+ merged into it: fifty arrow hits in one frame become one voice, louder than a single hit but not
+ fifty times louder. The merged requests go to the audio thread in Update().*/
+void Audio::PlaySFXIndex(int id, float volume, float pitch, float pan) {
+    statRequests++;
+    if (id < 0 || id >= (int)pendingIndex.size()) return;
+
+    if (pendingIndex[id] >= 0) {
+        SfxRequest& req = pending[pendingIndex[id]];
+        if (volume > req.volume) { req.volume = volume; req.pitch = pitch; req.pan = pan; }   // The loudest copy decides how and where it is heard.
+        req.count++;
+        statCoalesced++;
+        return;
     }
+    pendingIndex[id] = (int)pending.size();
+    pending.push_back({ id, volume, pitch, pan, 1 });
 }
 
-void Audio::PlayMusic(std::string name) {
-    if (musics.find(name) != musics.end()) {
+/* SOUND CULLING :
+ Within the hearing radius of the listener a sound plays at full volume, beyond it the volume falls off
+ linearly and reaches zero at twice the radius. Sounds that end up inaudible are dropped before they
+ reach the request list, so off-screen fights on a wide map cost nothing to mix.*/
+void Audio::PlaySFXAt(SoundId id, Vector2 worldPos, float volume, float pitch) {
+    if (hearingRadius <= 0.0f) { PlaySFXIndex((int)id, volume, pitch); return; }
+
+    float dx = worldPos.x - listenerPos.x;
+    float dy = worldPos.y - listenerPos.y;
+    float distance = sqrtf(dx * dx + dy * dy);
+    float gain = (distance <= hearingRadius) ? 1.0f : 2.0f - distance / hearingRadius;
+    if (volume * gain < SFX_AUDIBLE_VOLUME) { statRequests++; statCulled++; return; }
+
+    float side = dx / hearingRadius;
+    if (side < -1.0f) side = -1.0f;
+    if (side > 1.0f) side = 1.0f;
+    PlaySFXIndex((int)id, volume * gain, pitch, 0.5f - SFX_MAX_PAN * side);
+}
+
+// Slow path: one hash lookup per call. Game code uses the SoundId overload.
+void Audio::PlaySFX(const std::string& name, float volume, float pitch) {
+    auto it = soundIds.find(name);
+    if (it != soundIds.end()) PlaySFXIndex(it->second, volume, pitch);
+    else statRequests++;
+}
+
+// The game calls PlayMusic()/SetMusicVolume() every frame; only changes become commands.
+void Audio::PlayMusicIndex(int id, float fadeSeconds) {
+    if (id == requestedMusic) return;
+    requestedMusic = id;
+    requestedVolume = -1.0f;    // A new track starts at the default volume, so the next SetMusicVolume() must go through.
+    if (id == requestedPrefetch) requestedPrefetch = -1;
+    Command cmd = MakeCommand(CommandType::PLAY_MUSIC, id);
+    cmd.seconds = fadeSeconds;
+    Send(cmd);
+}
+
+void Audio::PlayMusic(const std::string& name) {
+    auto it = musicIds.find(name);
+    if (it != musicIds.end()) PlayMusicIndex(it->second, MUSIC_CROSSFADE_SECONDS);
+}
+
+void Audio::StopMusic(float fadeSeconds) {
+    requestedMusic = -1;
+    Command cmd = MakeCommand(CommandType::STOP_MUSIC, -1);
+    cmd.seconds = fadeSeconds;
+    Send(cmd);
+}
+
+// Like PlayMusic(), safe to call every frame; only a change of the prefetched track becomes a command.
+void Audio::PrefetchMusic(MusicId id) {
+    int index = (int)id;
+    if (index == requestedPrefetch || index == requestedMusic) return;
+    requestedPrefetch = index;
+    Send(MakeCommand(CommandType::PREFETCH_MUSIC, index));
+}
+
+void Audio::SetMusicVolume(float volume) {
+    if (volume == requestedVolume) return;
+    requestedVolume = volume;
+    Command cmd = MakeCommand(CommandType::MUSIC_VOLUME, -1);
+    cmd.volume = volume;
+    Send(cmd);
+}
+
+AudioStats Audio::GetStats() {
+    AudioStats s;
+    s.requests = statRequests.load();
+    s.coalesced = statCoalesced.load();
+    s.started = statStarted.load();
+    s.stolen = statStolen.load();
+    s.restarted = statRestarted.load();
+    s.dropped = statDropped.load();
+    s.culled = statCulled.load();
+    s.overBudget = statOverBudget.load();
+    return s;
+}
+
+void Audio::ResetStats() {
+    statRequests = 0; statCoalesced = 0; statStarted = 0; statStolen = 0; statRestarted = 0; statDropped = 0; statCulled = 0; statOverBudget = 0;
+}
+
+/* ---------------------------------------------------------------- audio thread */
+
+void Audio::ThreadMain() {
+    double last = NowSeconds();
+    while (true) {
+        Command cmd;
+        bool quit = false;
+        int active = -1;    // Playing voices, counted on the first PLAY_SFX of this batch.
+        while (commands.Pop(cmd)) {
+            if (cmd.type == CommandType::QUIT) { quit = true; break; }
+            Execute(cmd, active);
+        }
+        if (quit) break;
+
+        /* MUSIC STREAMING UPDATE :
+         Raylib's music system requires UpdateMusicStream() to be called regularly.
+         It refills the audio buffer; without this, music would play for a fraction of a second and stop.
+         Doing it here instead of once per game frame keeps the buffer filled however long a frame takes.*/
+        double now = NowSeconds();
+        UpdateMusic((float)(now - last));
+        last = now;
+        PublishCounters();
+        std::this_thread::sleep_for(std::chrono::milliseconds(AUDIO_THREAD_PERIOD_MS));
+    }
+
+    for (SfxEntry& entry : sounds) UnloadSFXEntry(entry);
+    for (int i = 0; i < (int)musics.size(); i++) UnloadMusicEntry(i);
+    sounds.clear();
+    musics.clear();
+    currentMusic = -1;
+    fadingMusic = -1;
+    prefetchedMusic = -1;
+    PublishCounters();
+}
+
+void Audio::Execute(Command& cmd, int& active) {
+    if (cmd.type == CommandType::LOAD_SFX || cmd.type == CommandType::SET_SFX_LIMITS || cmd.type == CommandType::PLAY_SFX) {
+        if ((int)sounds.size() <= cmd.id) sounds.resize(cmd.id + 1, { {}, DEFAULT_SFX_PRIORITY });
+    }
+    if (cmd.type == CommandType::LOAD_MUSIC || cmd.type == CommandType::UNLOAD_MUSIC || cmd.type == CommandType::PLAY_MUSIC || cmd.type == CommandType::PREFETCH_MUSIC) {
+        if ((int)musics.size() <= cmd.id) musics.resize(cmd.id + 1, { Music(), false, nullptr, 0 });
+    }
+
+    switch (cmd.type) {
+    case CommandType::LOAD_SFX: {
+        Sound snd = LoadSoundFromWave(cmd.wave);
+        UnloadWave(cmd.wave);
+        if (snd.frameCount == 0) break;
+        SfxEntry& entry = sounds[cmd.id];
+        UnloadSFXEntry(entry);
+        entry.voices.push_back({ snd, 0.0 });
+        for (int i = 1; i < DEFAULT_SFX_VOICES; i++) entry.voices.push_back({ LoadSoundAlias(snd), 0.0 });
+        break;
+    }
+    case CommandType::LOAD_MUSIC: {
+        UnloadMusicEntry(cmd.id);
+        MusicEntry& entry = musics[cmd.id];
+        SetAudioStreamBufferSizeDefault(MUSIC_STREAM_BUFFER_FRAMES);
+        entry.music = LoadMusicStreamFromMemory(cmd.fileType, cmd.data, cmd.dataSize);
+        SetAudioStreamBufferSizeDefault(0);     // Sound effects keep raylib's default.
+        entry.music.looping = true;
+        entry.loaded = true;
+        if (cmd.takeOwnership) { entry.ownedData = cmd.data; entry.ownedSize = cmd.dataSize; }
+        break;
+    }
+    case CommandType::UNLOAD_MUSIC:
+        UnloadMusicEntry(cmd.id);
+        break;
+    case CommandType::SET_SFX_LIMITS: {
+        SfxEntry& entry = sounds[cmd.id];
+        entry.priority = cmd.priority;
+        if (entry.voices.empty()) break;
+        while ((int)entry.voices.size() > cmd.count) {
+            UnloadSoundAlias(entry.voices.back().sound);
+            entry.voices.pop_back();
+        }
+        while ((int)entry.voices.size() < cmd.count) entry.voices.push_back({ LoadSoundAlias(entry.voices[0].sound), 0.0 });
+        break;
+    }
+    case CommandType::PLAY_SFX:
+        if (active < 0) active = CountPlayingVoices();
+        StartVoice(cmd, NowSeconds(), active);
+        break;
+    case CommandType::PLAY_MUSIC: {
+        if (!musics[cmd.id].loaded) break;
         /* BACKGROUND MUSIC SWITCHING :
          Checks if the requested track is different from the currently playing one.
-         If it is, it stops the old track and starts the new one. This prevents the 
-         music from restarting from the beginning if this function is called multiple times.*/
-        if (currentMusic != &musics[name]) {
-            if (currentMusic) StopMusicStream(*currentMusic);
-            currentMusic = &musics[name];
-            PlayMusicStream(*currentMusic);
-
-            
-            ::SetMusicVolume(*currentMusic, 0.5f);
+         If it is, the old track becomes the fading track and the new one fades in over it, so there is
+         no gap between them. This prevents the music from restarting from the beginning if this
+         function is called multiple times. A third track arriving mid-fade cuts the oldest one off.*/
+        if (currentMusic == cmd.id) break;
+        bool wasFading = (fadingMusic == cmd.id);
+        if (fadingMusic >= 0 && !wasFading) StopMusicStream(musics[fadingMusic].music);
+        fadingMusic = currentMusic;
+        fadingVolume = musicVolume * sinf(0.5f * PI * FadeProgress());
+        currentMusic = cmd.id;
+        musicVolume = DEFAULT_MUSIC_VOLUME;
+
+        Music& music = musics[cmd.id].music;
+        if (wasFading) {}               // Switched back mid-fade: it is still playing, it just fades in again.
+        else if (prefetchedMusic == cmd.id) {
+            ResumeMusicStream(music);   // Buffers were filled by PREFETCH_MUSIC; the first samples are ready.
+            prefetchedMusic = -1;
         }
+        else PlayMusicStream(music);
+        StartFade(cmd.seconds);
+        break;
+    }
+    case CommandType::STOP_MUSIC:
+        if (currentMusic < 0) break;
+        if (fadingMusic >= 0) StopMusicStream(musics[fadingMusic].music);
+        fadingMusic = currentMusic;
+        fadingVolume = musicVolume * sinf(0.5f * PI * FadeProgress());
+        currentMusic = -1;
+        StartFade(cmd.seconds);
+        break;
+    case CommandType::PREFETCH_MUSIC: {
+        /* MUSIC PREFETCH :
+         Starts the track silently and runs one stream update, which decodes enough audio to fill its
+         buffers, then pauses it. PLAY_MUSIC resumes it instead of opening the decoder and seeking to the
+         start, so the switch itself costs nothing. Only one track is kept prefetched.*/
+        int id = cmd.id;
+        if (!musics[id].loaded || id == currentMusic || id == prefetchedMusic) break;
+        if (prefetchedMusic >= 0 && prefetchedMusic != fadingMusic) StopMusicStream(musics[prefetchedMusic].music);
+        if (id == fadingMusic) { prefetchedMusic = -1; break; }
+        Music& music = musics[id].music;
+        ::SetMusicVolume(music, 0.0f);
+        PlayMusicStream(music);
+        UpdateMusicStream(music);
+        PauseMusicStream(music);
+        prefetchedMusic = id;
+        break;
+    }
+    case CommandType::MUSIC_VOLUME:
+        musicVolume = cmd.volume;
+        if (currentMusic >= 0 && fadingMusic < 0 && fadeElapsed >= fadeDuration) ::SetMusicVolume(musics[currentMusic].music, cmd.volume);
+        break;
+    case CommandType::QUIT:
+        break;
     }
 }
 
-void Audio::StopMusic() {
-    if (currentMusic) StopMusicStream(*currentMusic);
+void Audio::UnloadSFXEntry(SfxEntry& entry) {
+    if (entry.voices.empty()) return;
+    for (size_t i = 1; i < entry.voices.size(); i++) UnloadSoundAlias(entry.voices[i].sound);
+    UnloadSound(entry.voices[0].sound);
+    entry.voices.clear();
 }
 
-void Audio::SetMusicVolume(float volume) {
-    if (currentMusic) {
-        
-        ::SetMusicVolume(*currentMusic, volume);
+void Audio::UnloadMusicEntry(int id) {
+    MusicEntry& entry = musics[id];
+    if (currentMusic == id || fadingMusic == id || prefetchedMusic == id) StopMusicStream(entry.music);
+    if (currentMusic == id) currentMusic = -1;
+    if (fadingMusic == id) fadingMusic = -1;
+    if (prefetchedMusic == id) prefetchedMusic = -1;
+    if (entry.loaded) UnloadMusicStream(entry.music);
+    if (entry.ownedData) UnloadFileData(entry.ownedData);
+    entry = { Music(), false, nullptr, 0 };
+}
+
+// 0..1 through the running fade; 1 when no fade is running.
+float Audio::FadeProgress() {
+    if (fadeDuration <= 0.0f || fadeElapsed >= fadeDuration) return 1.0f;
+    return fadeElapsed / fadeDuration;
+}
+
+void Audio::StartFade(float seconds) {
+    fadeElapsed = 0.0f;
+    fadeDuration = (seconds > 0.0f) ? seconds : 0.0f;
+    if (currentMusic >= 0) ::SetMusicVolume(musics[currentMusic].music, (fadeDuration > 0.0f) ? 0.0f : musicVolume);
+    if (fadeDuration <= 0.0f && fadingMusic >= 0) {
+        StopMusicStream(musics[fadingMusic].music);
+        fadingMusic = -1;
+    }
+}
+
+/* CROSSFADE :
+ Equal-power curves (sin in, cos out) keep the overall loudness steady through the middle of the fade,
+ where a linear fade would dip. Both streams are refilled while the fade runs; the old one is stopped
+ when it reaches silence.*/
+void Audio::UpdateMusic(float dt) {
+    bool running = (fadeElapsed < fadeDuration);
+    if (running) fadeElapsed += dt;
+    float t = FadeProgress();
+
+    if (currentMusic >= 0) {
+        Music& music = musics[currentMusic].music;
+        if (running) ::SetMusicVolume(music, musicVolume * sinf(0.5f * PI * t));
+        UpdateMusicStream(music);
+    }
+    if (fadingMusic >= 0) {
+        Music& music = musics[fadingMusic].music;
+        if (t >= 1.0f) {
+            StopMusicStream(music);
+            fadingMusic = -1;
+        }
+        else {
+            ::SetMusicVolume(music, fadingVolume * cosf(0.5f * PI * t));
+            UpdateMusicStream(music);
+        }
+    }
+}
+
+/* VOICE ALLOCATION :
+ A sound uses a free voice of its own if it has one, otherwise its oldest voice is restarted, so a
+ sound can never have more copies playing than its voice count. When the pool as a whole is full,
+ the oldest voice of the least important sound (no more important than the request) is stopped;
+ if every playing voice outranks the request, the request is dropped.*/
+Audio::SfxVoice* Audio::FindVictim(int maxPriority) {
+    SfxVoice* victim = nullptr;
+    int victimPriority = 0;
+    for (SfxEntry& entry : sounds) {
+        int priority = entry.priority;
+        if (priority > maxPriority) continue;
+        for (SfxVoice& v : entry.voices) {
+            if (!IsSoundPlaying(v.sound)) continue;
+            if (!victim || priority < victimPriority || (priority == victimPriority && v.startTime < victim->startTime)) {
+                victim = &v;
+                victimPriority = priority;
+            }
+        }
+    }
+    return victim;
+}
+
+void Audio::StartVoice(const Command& cmd, double now, int& active) {
+    SfxEntry& entry = sounds[cmd.id];
+    if (entry.voices.empty()) return;
+
+    SfxVoice* freeVoice = nullptr;
+    SfxVoice* oldestOwn = nullptr;
+    for (SfxVoice& v : entry.voices) {
+        if (!IsSoundPlaying(v.sound)) { freeVoice = &v; break; }
+        if (!oldestOwn || v.startTime < oldestOwn->startTime) oldestOwn = &v;
+    }
+
+    SfxVoice* voice = freeVoice;
+    if (!freeVoice) {
+        StopSound(oldestOwn->sound);    // At its own cap: restart the oldest copy, pool size unchanged.
+        voice = oldestOwn;
+        statRestarted++;
+    }
+    else if (active >= MAX_VOICES) {
+        SfxVoice* victim = FindVictim(entry.priority);
+        if (!victim) { statDropped++; return; }
+        StopSound(victim->sound);
+        statStolen++;
+    }
+    else active++;
+
+    // Loudness grows with the log of the merged count, capped at twice a single request.
+    float scale = 1.0f + 0.3f * log2f((float)cmd.count);
+    if (scale > 2.0f) scale = 2.0f;
+    SetSoundVolume(voice->sound, cmd.volume * scale);
+    SetSoundPitch(voice->sound, cmd.pitch);
+    SetSoundPan(voice->sound, cmd.pan);
+    PlaySound(voice->sound);
+    voice->startTime = now;
+    statStarted++;
+}
+
+int Audio::CountPlayingVoices() {
+    int active = 0;
+    for (const SfxEntry& entry : sounds) {
+        for (const SfxVoice& v : entry.voices) if (IsSoundPlaying(v.sound)) active++;
+    }
+    return active;
+}
+
+void Audio::PublishCounters() {
+    size_t sfxBytes = 0;
+    for (const SfxEntry& entry : sounds) {
+        if (entry.voices.empty()) continue;
+        // Aliases share the samples of the first voice.
+        const Sound& snd = entry.voices[0].sound;
+        sfxBytes += (size_t)snd.frameCount * snd.stream.channels * (snd.stream.sampleSize / 8);
     }
+    size_t musBytes = 0;
+    for (const MusicEntry& entry : musics) musBytes += (size_t)entry.ownedSize;
+    activeVoices = CountPlayingVoices();
+    soundBytes = sfxBytes;
+    musicBytes = musBytes;
 }
@@ -0,0 +1,313 @@
+﻿#include "Benchmark.h"
+#include "World.h"
+#include "Renderer.h"
+#include "Snapshot.h"
+#include "SnapshotHistory.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static double NowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool ParseBenchmarkArgs(int argc, char** argv, BenchmarkOptions& options) {
+    bool bench = false;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--bench") == 0) bench = true;
+        else if (strcmp(argv[i], "--level") == 0 && hasValue) options.level = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) options.seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--seconds") == 0 && hasValue) options.seconds = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--soak") == 0) options.soak = true;
+        else if (strcmp(argv[i], "--lead") == 0) options.lead = true;
+    }
+    return bench;
+}
+
+/* BENCHMARK TOWERS :
+ Every third free tile that touches a road gets a tower, cycling archer / melee / ice / catapult /
+ lightning, in tile order; every sixth tower is a banner instead. Gold is ignored (the build cost is handed over first). This gives the towers, projectiles and grid queries a realistic share of the work
+ without depending on anyone's build order.*/
+static void PlaceTowers(World& world) {
+    const LevelData& level = *world.level;
+    const TowerType types[] = { TowerType::ARCHER, TowerType::MELEE, TowerType::ICE, TowerType::CATAPULT, TowerType::LIGHTNING };
+    int candidate = 0;
+    for (int y = 0; y < MAP_ROWS; y++) {
+        for (int x = 0; x < level.cols; x++) {
+            if (level.tileMap[y][x] != 0) continue;
+            bool nearRoad = (x > 0 && level.tileMap[y][x - 1] != 0) || (x + 1 < level.cols && level.tileMap[y][x + 1] != 0) ||
+                (y > 0 && level.tileMap[y - 1][x] != 0) || (y + 1 < MAP_ROWS && level.tileMap[y + 1][x] != 0);
+            if (!nearRoad) continue;
+            if (candidate++ % 3 != 0) continue;
+            Vector2 pos = { (float)x * TILE_SIZE + TILE_SIZE / 2, (float)y * TILE_SIZE + TILE_SIZE / 2 };
+            int n = (int)world.towers.size();
+            TowerType type = (n % 6 == 5) ? TowerType::BANNER : types[n % 5];
+            world.gold += Tower::GetBuildCost(type);
+            world.BuildTower(pos, type);
+        }
+    }
+}
+
+// FNV-1a over the parts of the state that any divergence would show up in.
+static unsigned long long Checksum(const World& world) {
+    unsigned long long h = 14695981039346656037ULL;
+    auto mix = [&](const void* data, size_t size) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++) { h ^= p[i]; h *= 1099511628211ULL; }
+    };
+    for (const Enemy& e : world.enemies) {
+        Vector2 pos = e.GetPosition();
+        int health = e.GetHealth();
+        mix(&pos, sizeof(pos));
+        mix(&health, sizeof(health));
+    }
+    mix(&world.gold, sizeof(world.gold));
+    mix(&world.totalKilled, sizeof(world.totalKilled));
+    mix(&world.rng.state, sizeof(world.rng.state));
+    return h;
+}
+
+/* CHAIN BENCHMARK :
+ Resolves lightning chains over CHAIN_ENEMIES enemies scattered uniformly over the map, once through
+ Tower::FindChain() (k-nearest queries on the grid) and once through a scan of the whole enemy list
+ per jump, which is what the chain would cost without the grid. Both must pick the same enemies.*/
+const int CHAIN_ENEMIES = 10000;
+const int CHAIN_SHOTS = 2000;
+
+static int FindChainByScan(const std::vector<Enemy>& enemies, int first, int jumps, float jumpRadius, int* out) {
+    int count = 0;
+    out[count++] = first;
+    while (count <= jumps) {
+        Vector2 from = enemies[out[count - 1]].GetPosition();
+        int next = -1;
+        float nearest = 0.0f;
+        for (int i = 0; i < (int)enemies.size(); i++) {
+            const Enemy& e = enemies[i];
+            if (!e.IsAlive()) continue;
+            bool struck = false;
+            for (int k = 0; k < count; k++) if (out[k] == i) struck = true;
+            if (struck) continue;
+            float d = Vector2Distance(from, e.GetPosition()) - e.GetRadius();
+            if (d <= jumpRadius && (next < 0 || d < nearest)) { next = i; nearest = d; }
+        }
+        if (next < 0) break;
+        out[count++] = next;
+    }
+    return count;
+}
+
+static void BenchmarkChains(LevelData& level, unsigned long long seed) {
+    Rng rng;
+    rng.Seed(seed);
+    float width = (float)level.mapWidth, height = (float)(MAP_ROWS * TILE_SIZE);
+    std::vector<Enemy> enemies;
+    enemies.reserve(CHAIN_ENEMIES);
+    for (int i = 0; i < CHAIN_ENEMIES; i++) {
+        Enemy e(EnemyType::ORC, level.paths[0], TextureHandle());
+        EnemyState s = e.GetState();
+        s.position = { rng.Float() * width, rng.Float() * height };
+        enemies.emplace_back(s, level.paths[0], TextureHandle());
+    }
+    EnemyGrid grid;
+    grid.Build(enemies, width, height);
+
+    std::vector<int> firsts(CHAIN_SHOTS);
+    for (int& f : firsts) f = rng.Range(0, CHAIN_ENEMIES - 1);
+    int chain[LIGHTNING_JUMPS + 1], reference[LIGHTNING_JUMPS + 1];
+    int struck = 0, mismatches = 0;
+    double t0 = NowMs();
+    for (int f : firsts) struck += Tower::FindChain(enemies, grid, f, LIGHTNING_JUMPS, LIGHTNING_JUMP_RADIUS, chain);
+    double gridMs = NowMs() - t0;
+    t0 = NowMs();
+    for (int f : firsts) FindChainByScan(enemies, f, LIGHTNING_JUMPS, LIGHTNING_JUMP_RADIUS, reference);
+    double scanMs = NowMs() - t0;
+    for (int f : firsts) {
+        int n = Tower::FindChain(enemies, grid, f, LIGHTNING_JUMPS, LIGHTNING_JUMP_RADIUS, chain);
+        if (n != FindChainByScan(enemies, f, LIGHTNING_JUMPS, LIGHTNING_JUMP_RADIUS, reference) || !std::equal(chain, chain + n, reference)) mismatches++;
+    }
+    printf("BENCH: chain lightning over %d enemies, %d chains (%.1f enemies each): grid %.4f ms per chain, full scan %.4f ms per chain (%.0fx), %s\n",
+        CHAIN_ENEMIES, CHAIN_SHOTS, (float)struck / CHAIN_SHOTS, gridMs / CHAIN_SHOTS, scanMs / CHAIN_SHOTS,
+        gridMs > 0.0 ? scanMs / gridMs : 0.0, mismatches == 0 ? "same chains" : "CHAINS DIFFER");
+}
+
+// A banner upgraded far past its cap (as an old save could hold it) must still leave enemies moving.
+static void CheckBannerAura() {
+    Tower banner({ 0.0f, 0.0f }, TextureHandle(), TextureHandle(), TowerType::BANNER);
+    int upgrades = 0;
+    while (banner.CanUpgrade()) { banner.Upgrade(); upgrades++; }
+    TowerAura capped = banner.GetAura();
+    for (int i = 0; i < 40; i++) banner.Upgrade();
+    TowerAura over = banner.GetAura();
+    bool ok = upgrades == BANNER_MAX_LEVEL - 1 && over.enemySlow <= MAX_AURA_SLOW && over.enemySlow == capped.enemySlow &&
+        over.rateBonus == capped.rateBonus && over.rangeBonus == capped.rangeBonus && over.damageBonus == capped.damageBonus;
+    printf("BENCH: banner aura at level %d: slow %.0f%%, rate +%.0f%%, range +%.0f%%, damage +%.0f%%; 40 levels past the cap %s\n",
+        BANNER_MAX_LEVEL, 100.0f * capped.enemySlow, 100.0f * capped.rateBonus, 100.0f * capped.rangeBonus, 100.0f * capped.damageBonus,
+        ok ? "same, ok" : "UNCAPPED");
+}
+
+struct TimingSummary {
+    double avg, p50, p95, max;
+};
+
+static TimingSummary Summarize(std::vector<double> samples) {
+    TimingSummary s = { 0.0, 0.0, 0.0, 0.0 };
+    if (samples.empty()) return s;
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    std::sort(samples.begin(), samples.end());
+    s.avg = sum / samples.size();
+    s.p50 = samples[samples.size() / 2];
+    s.p95 = samples[(samples.size() * 95) / 100];
+    s.max = samples.back();
+    return s;
+}
+
+int RunBenchmark(const BenchmarkOptions& options) {
+    std::vector<LevelData> levels = CreateLevels();
+    LevelData* level = nullptr;
+    for (LevelData& lvl : levels) if (lvl.levelID == options.level) level = &lvl;
+    if (!level) {
+        fprintf(stderr, "bench: no level with id %d\n", options.level);
+        DestroyLevels(levels);
+        return 1;
+    }
+
+    Renderer::SetBackend(RenderBackend::RECORDER);
+    World world;
+    world.Reset(level, options.seed);
+    if (options.soak) world.castleInvulnerable = true;
+    world.leadTargeting = options.lead;
+    PlaceTowers(world);
+
+    // The camera of a fresh game: the left end of the map, where every road enters.
+    const float dt = 1.0f / 60.0f;
+    const Rectangle view = { 0.0f, 0.0f, 1280.0f, 720.0f };
+    int ticks = (int)(options.seconds / dt);
+    std::vector<double> simMs, renderMs, recordMs;
+    simMs.reserve(ticks);
+    renderMs.reserve(ticks);
+    recordMs.reserve(ticks);
+    // Recorded like in the game, so its cost and memory show up here; timed apart from the simulation.
+    SnapshotHistory history;
+    history.Configure(HistoryConfigFor(*level));
+    WorldRenderList renderList;
+    int peakEnemies = 0, peakProjectiles = 0, peakDrawCalls = 0, peakEffects = 0;
+    size_t peakMemory = 0, peakHistoryMemory = 0;
+    float peakHistoryRate = 0.0f;
+    double effectsMs = 0.0;
+    // Soak report: one line per simulated minute.
+    const int ticksPerMinute = 3600;
+    double minuteSimMs = 0.0, minuteSimMax = 0.0, firstMinuteAvg = 0.0, lastMinuteAvg = 0.0;
+    int minutes = 0;
+    // Soak check: isBossActive must fall back to false once the last Nazgul of a boss wave is gone.
+    int bossWaves = 0, bossFlagStuck = 0;
+    bool bossOnField = false;
+
+    double start = NowMs();
+    int tick = 0;
+    for (; tick < ticks && world.outcome == WorldOutcome::RUNNING; tick++) {
+        world.Update(dt);
+        simMs.push_back(world.GetLastUpdateMs());
+
+        Renderer::BeginFrame();
+        world.Draw(renderList, view);
+        Renderer::EndFrame();
+        RenderStats stats = Renderer::GetStats();
+        renderMs.push_back(stats.cpuMs);
+        history.Record(world, dt);
+        recordMs.push_back(history.GetLastRecordMs());
+        peakHistoryMemory = std::max(peakHistoryMemory, history.GetMemoryBytes());
+        peakHistoryRate = std::max(peakHistoryRate, history.GetBytesPerMinute());
+
+        peakEnemies = std::max(peakEnemies, (int)world.enemies.size());
+        peakProjectiles = std::max(peakProjectiles, (int)world.projectiles.size());
+        peakEffects = std::max(peakEffects, world.effects.Count());
+        effectsMs += world.GetLastEffectsMs();
+        peakDrawCalls = std::max(peakDrawCalls, stats.drawCalls);
+        peakMemory = std::max(peakMemory, world.GetMemoryBytes());
+
+        if (options.soak) {
+            bool nazgul = world.enemiesByType[(int)EnemyType::NAZGUL] > 0;
+            if (bossOnField && !nazgul) {
+                bossWaves++;
+                if (world.isBossActive) bossFlagStuck++;
+            }
+            bossOnField = nazgul;
+            minuteSimMs += simMs.back();
+            minuteSimMax = std::max(minuteSimMax, simMs.back());
+            if ((tick + 1) % ticksPerMinute == 0) {
+                lastMinuteAvg = minuteSimMs / ticksPerMinute;
+                if (minutes == 0) firstMinuteAvg = lastMinuteAvg;
+                minutes++;
+                printf("BENCH: minute %d  wave %d  enemies %d  sim avg %.3f ms  max %.3f ms  world memory %zu KB\n",
+                    minutes, world.currentWaveIndex + 1, (int)world.enemies.size(), lastMinuteAvg, minuteSimMax, world.GetMemoryBytes() / 1024);
+                minuteSimMs = 0.0; minuteSimMax = 0.0;
+            }
+        }
+    }
+    double wallMs = NowMs() - start;
+
+    TimingSummary sim = Summarize(simMs);
+    TimingSummary render = Summarize(renderMs);
+    const char* outcome = (world.outcome == WorldOutcome::VICTORY) ? "victory" : (world.outcome == WorldOutcome::DEFEAT) ? "defeat" : "running";
+    char waveLabel[32];
+    int waveNumber = std::min(world.currentWaveIndex + 1, level->endless ? world.currentWaveIndex + 1 : (int)level->waves.size());
+    if (level->endless) snprintf(waveLabel, sizeof(waveLabel), "wave %d", waveNumber);
+    else snprintf(waveLabel, sizeof(waveLabel), "wave %d of %d", waveNumber, (int)level->waves.size());
+    printf("BENCH: level \"%s\", seed %llu, %d ticks of %.1f ms simulated in %.0f ms (%s, %s)\n",
+        level->name, options.seed, tick, dt * 1000.0f, wallMs, outcome, waveLabel);
+    printf("BENCH: sim    avg %.3f ms  p50 %.3f ms  p95 %.3f ms  max %.3f ms\n", sim.avg, sim.p50, sim.p95, sim.max);
+    printf("BENCH: render avg %.3f ms  p50 %.3f ms  p95 %.3f ms  max %.3f ms  (peak %d draw calls)\n", render.avg, render.p50, render.p95, render.max, peakDrawCalls);
+    printf("BENCH: enemies peak %d, spawned %d, killed %d, leaked %d; towers %d; projectiles peak %d\n",
+        peakEnemies, world.totalSpawned, world.totalKilled, world.totalLeaked, (int)world.towers.size(), peakProjectiles);
+    printf("BENCH: splash %d blasts, %.1f enemies caught per blast; %d homing projectiles retired early\n", world.totalBlasts,
+        world.totalBlasts > 0 ? (float)world.totalBlastHits / world.totalBlasts : 0.0f, world.totalRetired);
+    printf("BENCH: shots %d, accuracy %.1f%%, %.2f shots per kill (lead targeting %s)\n", world.totalShots,
+        world.totalShots > 0 ? 100.0f * world.totalShotHits / world.totalShots : 0.0f,
+        world.totalKilled > 0 ? (float)world.totalShots / world.totalKilled : 0.0f, options.lead ? "on" : "off");
+    printf("BENCH: status effects peak %d, tick avg %.4f ms\n", peakEffects, tick > 0 ? effectsMs / tick : 0.0);
+    printf("BENCH: world memory peak %zu KB, at end %zu KB\n", peakMemory / 1024, world.GetMemoryBytes() / 1024);
+    if (options.soak) printf("BENCH: boss flag cleared after %d of %d boss waves, %s\n", bossWaves - bossFlagStuck, bossWaves, bossFlagStuck == 0 ? "ok" : "STUCK");
+    if (minutes > 1) printf("BENCH: sim drift, last minute vs first: %.2fx\n", firstMinuteAvg > 0.0 ? lastMinuteAvg / firstMinuteAvg : 0.0);
+    unsigned long long checksum = Checksum(world);
+    printf("BENCH: checksum %016llx\n", checksum);
+
+    // Save-state round trip on the final state: both directions timed, and the reloaded world must match.
+    std::vector<unsigned char> snapshot;
+    double t0 = NowMs();
+    world.SaveSnapshot(snapshot);
+    double writeMs = NowMs() - t0;
+    t0 = NowMs();
+    bool loaded = world.LoadSnapshot(snapshot.data(), snapshot.size());
+    double readMs = NowMs() - t0;
+    bool match = loaded && Checksum(world) == checksum;
+    printf("BENCH: snapshot %d bytes (%d enemies), write %.3f ms, read %.3f ms, round trip %s\n",
+        (int)snapshot.size(), (int)world.enemies.size(), writeMs, readMs, match ? "ok" : "MISMATCH");
+
+    /* REWIND CHECK :
+     Rewinding 30 s and simulating the same ticks again has to land on the same checksum; anything the
+     snapshots miss, or any randomness outside the World's Rng, shows up as a mismatch.*/
+    TimingSummary record = Summarize(recordMs);
+    printf("BENCH: history %d snapshots over %.0f s, %.0f KB per minute (peak %.0f), %zu KB held (peak %zu); record avg %.3f ms  p95 %.3f ms  max %.3f ms\n",
+        history.Count(), history.GetCoveredSeconds(), history.GetBytesPerMinute() / 1024.0f, peakHistoryRate / 1024.0f,
+        history.GetMemoryBytes() / 1024, peakHistoryMemory / 1024, record.avg, record.p95, record.max);
+    t0 = NowMs();
+    float rewound = history.Rewind(world, 30.0f);
+    double rewindMs = NowMs() - t0;
+    if (rewound >= 0.0f) {
+        int replayTicks = (int)(rewound / dt + 0.5f);
+        for (int i = 0; i < replayTicks; i++) world.Update(dt);
+        printf("BENCH: rewind %.1f s in %.3f ms, replay of %d ticks %s\n", rewound, rewindMs, replayTicks, Checksum(world) == checksum ? "ok" : "MISMATCH");
+    }
+
+    BenchmarkChains(*level, options.seed);
+    CheckBannerAura();
+
+    world.Reset(nullptr, 0);
+    DestroyLevels(levels);
+    return 0;
+}
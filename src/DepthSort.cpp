@@ -0,0 +1,101 @@
+﻿#include "DepthSort.h"
+#include <cstring>
+
+void WorldRenderList::Clear() {
+    keys.clear();
+    items.clear();
+    // 'sorted' is kept on purpose: it is the previous frame's order and the first guess for the next Sort().
+}
+
+/* KEY PACKING :
+ The top 8 bits hold the layer, the low 24 bits the y coordinate in quarter pixels, biased so
+ that negative positions (projectiles leaving the top of the map) still sort correctly.
+ Unsigned integer order of the key is exactly the (layer, y) draw order.*/
+unsigned int WorldRenderList::MakeKey(RenderLayer layer, float y) {
+    float fixedY = (y + 8192.0f) * 4.0f;
+    if (fixedY < 0.0f) fixedY = 0.0f;
+    if (fixedY > 16777215.0f) fixedY = 16777215.0f;
+    return ((unsigned int)layer << 24) | (unsigned int)fixedY;
+}
+
+void WorldRenderList::Add(RenderLayer layer, float y, RenderKind kind, int index) {
+    keys.push_back(MakeKey(layer, y));
+    items.push_back({ kind, index });
+}
+
+void WorldRenderList::Sort() {
+    if (TryPreviousOrder()) return;
+    RadixSort();
+    lastSortPath = 2;
+}
+
+/* FRAME-TO-FRAME COHERENCE :
+ Entities move a few pixels per frame, so last frame's order is usually still correct or only off
+ by a handful of neighbour swaps. If the entry count did not change, that order is reused and
+ repaired with an insertion sort whose work is capped; ties are broken by Add() order so the
+ result is identical to what the stable radix sort would produce. When the cap is hit, or entities
+ were added/removed, the radix sort runs instead.*/
+bool WorldRenderList::TryPreviousOrder() {
+    size_t n = keys.size();
+    if (n == 0 || sorted.size() != n) return false;
+
+    size_t budget = n / 8 + 32;
+    size_t moves = 0;
+    for (size_t i = 1; i < n; i++) {
+        unsigned int idx = sorted[i];
+        unsigned int key = keys[idx];
+        size_t j = i;
+        while (j > 0) {
+            unsigned int prev = sorted[j - 1];
+            if (keys[prev] < key || (keys[prev] == key && prev < idx)) break;
+            sorted[j] = prev;
+            j--;
+            if (++moves > budget) {
+                sorted[j] = idx;
+                return false;
+            }
+        }
+        sorted[j] = idx;
+    }
+    lastSortPath = (moves == 0) ? 0 : 1;
+    return true;
+}
+
+/* RADIX SORT :
+ Least-significant-digit sort over four 8-bit digits. All histograms are built in a single read of the
+ keys; a digit whose values are all identical (typically the layer byte, or the high y byte when every
+ entity is on screen) is skipped because that pass would not change the order.*/
+void WorldRenderList::RadixSort() {
+    size_t n = keys.size();
+    sorted.resize(n);
+    scratch.resize(n);
+    for (size_t i = 0; i < n; i++) sorted[i] = (unsigned int)i;
+
+    unsigned int counts[4][256];
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < n; i++) {
+        unsigned int k = keys[i];
+        counts[0][k & 0xFF]++;
+        counts[1][(k >> 8) & 0xFF]++;
+        counts[2][(k >> 16) & 0xFF]++;
+        counts[3][k >> 24]++;
+    }
+
+    lastRadixPasses = 0;
+    for (int pass = 0; pass < 4; pass++) {
+        unsigned int* count = counts[pass];
+        int shift = pass * 8;
+        if (n == 0 || count[(keys[0] >> shift) & 0xFF] == n) continue;
+
+        unsigned int offsets[256];
+        unsigned int sum = 0;
+        for (int b = 0; b < 256; b++) { offsets[b] = sum; sum += count[b]; }
+
+        for (size_t i = 0; i < n; i++) {
+            unsigned int idx = sorted[i];
+            scratch[offsets[(keys[idx] >> shift) & 0xFF]++] = idx;
+        }
+        sorted.swap(scratch);
+        lastRadixPasses++;
+    }
+}
@@ -0,0 +1,61 @@
+﻿#include "EnemyGrid.h"
+
+constexpr float EnemyGrid::CELL_SIZE;
+constexpr int EnemyGrid::MAX_NEAREST;
+
+// Positions outside the map (spawn points on the edge, the castle end) are clamped into the border cells.
+int EnemyGrid::CellOf(float x, float y) const {
+    int cx = (int)(x / CELL_SIZE);
+    int cy = (int)(y / CELL_SIZE);
+    if (cx < 0) cx = 0; else if (cx >= cols) cx = cols - 1;
+    if (cy < 0) cy = 0; else if (cy >= rows) cy = rows - 1;
+    return cy * cols + cx;
+}
+
+void EnemyGrid::CellRange(Vector2 center, float reach, int& x0, int& y0, int& x1, int& y1) const {
+    x0 = (int)((center.x - reach) / CELL_SIZE);
+    y0 = (int)((center.y - reach) / CELL_SIZE);
+    x1 = (int)((center.x + reach) / CELL_SIZE);
+    y1 = (int)((center.y + reach) / CELL_SIZE);
+    if (center.x - reach < 0.0f) x0 = 0;
+    if (center.y - reach < 0.0f) y0 = 0;
+    if (x0 >= cols) x0 = cols - 1;
+    if (y0 >= rows) y0 = rows - 1;
+    if (x1 < 0) x1 = 0; else if (x1 >= cols) x1 = cols - 1;
+    if (y1 < 0) y1 = 0; else if (y1 >= rows) y1 = rows - 1;
+}
+
+void EnemyGrid::Build(const std::vector<Enemy>& enemies, float worldWidth, float worldHeight) {
+    cols = (int)(worldWidth / CELL_SIZE) + 1;
+    rows = (int)(worldHeight / CELL_SIZE) + 1;
+    int cellCount = cols * rows;
+    cellStart.assign(cellCount + 1, 0);
+    cellOfEnemy.resize(enemies.size());
+    maxRadius = 0.0f;
+
+    // Pass 1: count per cell. Dead enemies are skipped, they only wait for the removal pass.
+    int alive = 0;
+    for (size_t i = 0; i < enemies.size(); i++) {
+        const Enemy& e = enemies[i];
+        if (!e.IsAlive()) { cellOfEnemy[i] = -1; continue; }
+        Vector2 p = e.GetPosition();
+        int cell = CellOf(p.x, p.y);
+        cellOfEnemy[i] = cell;
+        cellStart[cell + 1]++;
+        if (e.GetRadius() > maxRadius) maxRadius = e.GetRadius();
+        alive++;
+    }
+    for (int c = 0; c < cellCount; c++) cellStart[c + 1] += cellStart[c];
+
+    // Pass 2: scatter into place. 'cellStart[c]' is used as the write cursor and restored afterwards.
+    entries.resize(alive);
+    for (size_t i = 0; i < enemies.size(); i++) {
+        int cell = cellOfEnemy[i];
+        if (cell < 0) continue;
+        const Enemy& e = enemies[i];
+        Vector2 p = e.GetPosition();
+        entries[cellStart[cell]++] = { p.x, p.y, e.GetRadius(), (int)i };
+    }
+    for (int c = cellCount; c > 0; c--) cellStart[c] = cellStart[c - 1];
+    cellStart[0] = 0;
+}
@@ -0,0 +1,135 @@
+﻿#include "Hud.h"
+#include "Renderer.h"
+#include "TextCache.h"
+#include "rlgl.h"
+
+void Hud::Init(int w, int h, Texture2D btnNormal, Texture2D btnHover, int maxBloodValue, int gandalfCost, int rohirrimCost) {
+    width = w; height = h;
+    texBtnNormal = btnNormal; texBtnHover = btnHover;
+    maxBlood = maxBloodValue; costGandalf = gandalfCost; costRohirrim = rohirrimCost;
+    menuButton = { (float)width - 120, 10, 100, 30 };
+    if (Renderer::GetBackend() == RenderBackend::RAYLIB) {
+        barTexture = LoadRenderTexture(width, BAR_HEIGHT);
+        buttonTexture = LoadRenderTexture((int)menuButton.width, (int)menuButton.height);
+    }
+    dirty = HUD_DIRTY_ALL;
+}
+
+void Hud::Unload() {
+    if (barTexture.id > 0) UnloadRenderTexture(barTexture);
+    if (buttonTexture.id > 0) UnloadRenderTexture(buttonTexture);
+    barTexture = { 0 };
+    buttonTexture = { 0 };
+}
+
+void Hud::SetGold(int value) {
+    if (value != gold) { gold = value; dirty |= HUD_DIRTY_GOLD; }
+}
+
+void Hud::SetWave(int index, int count) {
+    if (index != waveIndex || count != waveCount) { waveIndex = index; waveCount = count; dirty |= HUD_DIRTY_WAVE; }
+}
+
+void Hud::SetSelectedTower(TowerType type) {
+    if (type != selectedTower) { selectedTower = type; dirty |= HUD_DIRTY_TOWER; }
+}
+
+void Hud::SetUrukBlood(int value) {
+    if (value != urukBlood) { urukBlood = value; dirty |= HUD_DIRTY_BLOOD; }
+}
+
+void Hud::SetMenuButtonState(bool hover, bool pressed) {
+    if (hover != menuHover || pressed != menuPressed) { menuHover = hover; menuPressed = pressed; dirty |= HUD_DIRTY_HOVER; }
+}
+
+/* HUD COMPOSITION :
+ Same layout as the old immediate-mode bottom bar, in panel-local coordinates. Panels are drawn into
+ transparent textures, so the alpha channel is written with separate blend factors (color:
+ SRC_ALPHA/ONE_MINUS_SRC_ALPHA, alpha: ONE/ONE_MINUS_SRC_ALPHA). The textures then hold premultiplied
+ colors with correct coverage and are composited with BLEND_ALPHA_PREMULTIPLY, giving the same pixels as
+ drawing directly.*/
+static void BeginPanel(RenderTexture2D target) {
+    Renderer::BeginTextureMode(target);
+    Renderer::ClearBackground(BLANK);
+    if (Renderer::GetBackend() == RenderBackend::RAYLIB) rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+    Renderer::BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+}
+
+static void EndPanel() {
+    Renderer::EndBlendMode();
+    Renderer::EndTextureMode();
+}
+
+void Hud::RecomposeBar() {
+    BeginPanel(barTexture);
+    const int h = BAR_HEIGHT;
+    Renderer::DrawRectangle(0, 0, width, h, Fade(BLACK, 0.9f));
+    char label[32];
+    TextCache::Draw(TextCache::Format(label, sizeof(label), "Gold: ", gold), 20, h - 45, 20, YELLOW);
+    if (waveCount > 0) TextCache::Draw(TextCache::Format(label, sizeof(label), "Wave: ", waveIndex + 1, " / ", waveCount), 20, h - 25, 20, WHITE);
+    else TextCache::Draw(TextCache::Format(label, sizeof(label), "Wave: ", waveIndex + 1), 20, h - 25, 20, WHITE);
+    Color c1 = (selectedTower == TowerType::ARCHER) ? YELLOW : GRAY;
+    Color c2 = (selectedTower == TowerType::MELEE) ? RED : GRAY;
+    Color c3 = (selectedTower == TowerType::ICE) ? SKYBLUE : GRAY;
+    Color c4 = (selectedTower == TowerType::BANNER) ? GOLD : GRAY;
+    Color c5 = (selectedTower == TowerType::CATAPULT) ? ORANGE : GRAY;
+    Color c6 = (selectedTower == TowerType::LIGHTNING) ? SKYBLUE : GRAY;
+    TextCache::Draw("[1] Archer", 170, h - 40, 20, c1);
+    TextCache::Draw("[2] Melee", 285, h - 40, 20, c2);
+    TextCache::Draw("[3] Ice", 390, h - 40, 20, c3);
+    TextCache::Draw("[4] Banner", 460, h - 40, 20, c4);
+    TextCache::Draw("[5] Catapult", 570, h - 40, 20, c5);
+    TextCache::Draw("[6] Lightning", 695, h - 40, 20, c6);
+    int rightX = width - 450; int uiBarY = h - 35;
+    Renderer::DrawRectangleLines(rightX, uiBarY, 120, 15, GRAY);
+    float bloodPct = (float)urukBlood / maxBlood;
+    Renderer::DrawRectangle(rightX + 1, uiBarY + 1, (int)(118 * bloodPct), 13, MAROON);
+    TextCache::Draw("BLOOD", rightX + 40, uiBarY + 3, 10, WHITE);
+    Color cQ = (urukBlood >= costGandalf) ? WHITE : DARKGRAY;
+    Color cW = (urukBlood >= costRohirrim) ? WHITE : DARKGRAY;
+    TextCache::Draw("[Q] GANDALF", rightX + 130, uiBarY - 5, 20, cQ);
+    TextCache::Draw("[W] ROHIRRIM", rightX + 280, uiBarY - 5, 20, cW);
+    EndPanel();
+    recomposeCount++;
+}
+
+void Hud::RecomposeButton() {
+    BeginPanel(buttonTexture);
+    Rectangle rect = { 0, 0, menuButton.width, menuButton.height };
+    if (menuHover && menuPressed) {
+        if (texBtnHover.id > 0) Renderer::DrawTexturePro(texBtnHover, { 0,0,(float)texBtnHover.width,(float)texBtnHover.height }, { rect.x + 2, rect.y + 2, rect.width - 4, rect.height - 4 }, { 0,0 }, 0, WHITE);
+        else { Renderer::DrawRectangleRec(rect, Color{ 80, 80, 80, 255 }); Renderer::DrawRectangleLinesEx(rect, 4, DARKBROWN); }
+    }
+    else if (menuHover) {
+        if (texBtnHover.id > 0) Renderer::DrawTexturePro(texBtnHover, { 0,0,(float)texBtnHover.width,(float)texBtnHover.height }, rect, { 0,0 }, 0, WHITE);
+        else { Renderer::DrawRectangleRec(rect, Color{ 169, 169, 169, 255 }); Renderer::DrawRectangleLinesEx(rect, 4, GOLD); }
+    }
+    else {
+        if (texBtnNormal.id > 0) Renderer::DrawTexturePro(texBtnNormal, { 0,0,(float)texBtnNormal.width,(float)texBtnNormal.height }, rect, { 0,0 }, 0, WHITE);
+        else { Renderer::DrawRectangleRec(rect, DARKGRAY); Renderer::DrawRectangleLinesEx(rect, 4, BLACK); }
+    }
+    int fontSize = 20; int textWidth = TextCache::Measure("MENU", fontSize);
+    int textX = (int)(rect.x + (rect.width - textWidth) / 2); int textY = (int)(rect.y + (rect.height - fontSize) / 2);
+    TextCache::Draw("MENU", textX + 2, textY + 2, fontSize, BLACK);
+    TextCache::Draw("MENU", textX, textY, fontSize, menuHover ? DARKBLUE : RAYWHITE);
+    EndPanel();
+    recomposeCount++;
+}
+
+void Hud::Draw(RenderTexture2D outerTarget) {
+    if (dirty != HUD_DIRTY_NONE) {
+        /* raylib cannot nest texture modes, so the outer target is unbound for the recompose and bound again.
+         Its content is kept, only the batch is flushed.*/
+        Renderer::EndTextureMode();
+        if (dirty & HUD_DIRTY_BAR) RecomposeBar();
+        if (dirty & HUD_DIRTY_HOVER) RecomposeButton();
+        Renderer::BeginTextureMode(outerTarget);
+        dirty = HUD_DIRTY_NONE;
+    }
+
+    // Steady state: one textured quad per panel. Render textures are stored upside down, hence the negative source height.
+    Renderer::BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    Renderer::DrawTexturePro(barTexture.texture, { 0, 0, (float)width, -(float)BAR_HEIGHT }, { 0, (float)(height - BAR_HEIGHT), (float)width, (float)BAR_HEIGHT }, { 0, 0 }, 0.0f, WHITE);
+    Renderer::DrawTexturePro(buttonTexture.texture, { 0, 0, menuButton.width, -menuButton.height }, menuButton, { 0, 0 }, 0.0f, WHITE);
+    Renderer::EndBlendMode();
+}
@@ -0,0 +1,307 @@
+﻿#include "Level.h"
+#include "Rng.h"
+#include <cmath>
+
+// Recursive Depth-First Search (DFS) algorithm to find all valid paths from start to finish.
+// It marks tiles as visited (-1) to prevent loops, explores all 4 cardinal directions,
+// and backtracks (resets tile value) to allow finding alternative routes.
+static void FindAllPathsRecursive(int x, int y, int cols, int rows,
+    std::vector<std::vector<int>>& tileMap,
+    std::vector<Vector2> currentPath,
+    std::vector<std::vector<Vector2>*>& outPaths)
+{
+    currentPath.push_back({ (float)x * TILE_SIZE + TILE_SIZE / 2, (float)y * TILE_SIZE + TILE_SIZE / 2 });
+
+    if (tileMap[y][x] == 3) {
+        outPaths.push_back(new std::vector<Vector2>(currentPath));
+        return;
+    }
+
+    int originalValue = tileMap[y][x];
+    tileMap[y][x] = -1;
+
+    int dx[] = { 1, 0, -1, 0 };
+    int dy[] = { 0, 1, 0, -1 };
+
+    for (int i = 0; i < 4; i++) {
+        int nx = x + dx[i];
+        int ny = y + dy[i];
+
+        if (nx >= 0 && nx < cols && ny >= 0 && ny < rows) {
+            if (tileMap[ny][nx] == 1 || tileMap[ny][nx] == 3) {
+                FindAllPathsRecursive(nx, ny, cols, rows, tileMap, currentPath, outPaths);
+            }
+        }
+    }
+    tileMap[y][x] = originalValue;
+}
+
+
+std::vector<std::vector<Vector2>*> GeneratePathsFromMap(const std::vector<std::vector<int>>& map) {
+    std::vector<std::vector<Vector2>*> allPaths;
+    if (map.empty()) return allPaths;
+
+    int rows = map.size();
+    int cols = map[0].size();
+    std::vector<std::vector<int>> tempMap = map;
+
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            if (tempMap[y][x] == 2) {
+                std::vector<Vector2> initialPath;
+                FindAllPathsRecursive(x, y, cols, rows, tempMap, initialPath, allPaths);
+            }
+        }
+    }
+    return allPaths;
+}
+
+std::vector<LevelData> CreateLevels() {
+    std::vector<LevelData> levels;
+
+    {
+        LevelData lvl; lvl.levelID = 1; lvl.name = "Level 1: Outskirts";
+        lvl.background = { 0 }; lvl.backgroundPath = "assets/sprites/environment/minastirith_bg.png";
+        lvl.music = { { "music_level1", "assets/sounds/music_level1.mp3" } };
+        lvl.bgColor = DARKGREEN;
+        lvl.startGold = 400;
+        int width = 30; lvl.cols = width; lvl.mapWidth = width * TILE_SIZE;
+        lvl.castlePos = { 1550.0f, 120.0f }; lvl.castleScale = 0.5f;
+        int design[12][30] = {
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {2,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,3,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
+        };
+        lvl.tileMap.resize(MAP_ROWS);
+        for (int y = 0; y < MAP_ROWS; y++) { lvl.tileMap[y].resize(width); for (int x = 0; x < width; x++) lvl.tileMap[y][x] = design[y][x]; }
+        lvl.paths = GeneratePathsFromMap(lvl.tileMap);
+
+        lvl.waves.push_back({ 5, EnemyType::ORC, 1.5f, 1.0f, 0 });
+        lvl.waves.push_back({ 12, EnemyType::ORC, 1.0f, 1.1f, 0 });
+        lvl.waves.push_back({ 5, EnemyType::URUK, 2.0f, 0.9f, 10 });
+        lvl.waves.push_back({ 15, EnemyType::ORC, 0.8f, 1.2f, 5 });
+        lvl.waves.push_back({ 15, EnemyType::URUK, 1.5f, 1.0f, 20 });
+
+        lvl.storyLines = {
+            "CHAPTER 1: THE OUTSKIRTS",
+            "Scouts report Orc activity near the farm lands.",
+            "They are testing our defenses.",
+            "Hold them off before they reach the main gate."
+        };
+        levels.push_back(lvl);
+    }
+
+    
+    {
+        LevelData lvl; lvl.levelID = 2; lvl.name = "Level 2: Long Road";
+        lvl.background = { 0 }; lvl.backgroundPath = "assets/sprites/environment/lvl2_bg.png";
+        lvl.music = { { "music_level2", "assets/sounds/music_level2.wav" } };
+        lvl.bgColor = DARKGREEN;
+        lvl.startGold = 600;
+        int width = 30; lvl.cols = width; lvl.mapWidth = width * TILE_SIZE;
+        lvl.castlePos = { 1550.0f, 120.0f }; lvl.castleScale = 0.5f;
+        int design[12][30] = {
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {2,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,1,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,3,0,0,0,0},
+            {2,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
+        };
+        lvl.tileMap.resize(MAP_ROWS);
+        for (int y = 0; y < MAP_ROWS; y++) { lvl.tileMap[y].resize(width); for (int x = 0; x < width; x++) lvl.tileMap[y][x] = design[y][x]; }
+        lvl.paths = GeneratePathsFromMap(lvl.tileMap);
+
+        lvl.waves.push_back({ 10, EnemyType::ORC, 1.0f, 1.1f, 5 });
+        lvl.waves.push_back({ 8, EnemyType::URUK, 1.5f, 1.0f, 10 });
+        lvl.waves.push_back({ 2, EnemyType::COMMANDER, 2.0f, 1.0f, 0 });
+        lvl.waves.push_back({ 4, EnemyType::TROLL, 5.0f, 1.0f, 20 });
+        lvl.waves.push_back({ 3, EnemyType::GROND, 5.0f, 1.0f, 50 });
+
+        lvl.storyLines = {
+            "CHAPTER 2: THE LONG ROAD",
+            "Osgiliath has fallen.",
+            "The enemy is marching towards the Great River.",
+            "Ambush their vanguards on the road!",
+            "Beware of the Trolls."
+        };
+        levels.push_back(lvl);
+    }
+
+    
+    {
+        LevelData lvl; lvl.levelID = 3; lvl.name = "Level 3: The Siege";
+        lvl.background = { 0 }; lvl.backgroundPath = "assets/sprites/environment/lvl3_bg.png";
+        lvl.music = { { "music_level3", "assets/sounds/music_level3.mp3" }, { "music_boss", "assets/sounds/nazgul_boss.mp3" } };
+        lvl.bgColor = DARKGREEN;
+        lvl.startGold = 700;
+        int width = 50; lvl.cols = width; lvl.mapWidth = width * TILE_SIZE;
+        lvl.castlePos = { 2700.0f, 90.0f }; lvl.castleScale = 0.5f;
+        int design[12][50] = {
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {2,1,1,1,0,0,0,0,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,1,1,1,1,1,1,1,1,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,3,0,0,0,0,0,0},
+            {2,1,1,1,1,1,1,1,1,1,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,1,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
+        };
+        lvl.tileMap.resize(MAP_ROWS);
+        for (int y = 0; y < MAP_ROWS; y++) { lvl.tileMap[y].resize(width); for (int x = 0; x < width; x++) lvl.tileMap[y][x] = design[y][x]; }
+        lvl.paths = GeneratePathsFromMap(lvl.tileMap);
+
+        lvl.waves.push_back({ 20, EnemyType::ORC, 0.8f, 1.0f, 10 });
+        lvl.waves.push_back({ 15, EnemyType::URUK, 1.0f, 1.1f, 20 });
+        lvl.waves.push_back({ 25, EnemyType::ORC, 0.6f, 1.1f, 15 });
+        lvl.waves.push_back({ 6,  EnemyType::TROLL, 4.0f, 1.0f, 50 });
+        lvl.waves.push_back({ 25, EnemyType::URUK, 0.7f, 1.3f, 30 }); 
+        lvl.waves.push_back({ 5, EnemyType::COMMANDER, 2.0f, 1.0f, 0 });
+        lvl.waves.push_back({ 3, EnemyType::GROND, 5.0f, 1.0f, 100 });
+        lvl.waves.push_back({ 1,  EnemyType::NAZGUL, 5.0f, 1.5f, 500 });
+
+        lvl.storyLines = {
+            "CHAPTER 3: THE SIEGE BEGINS",
+            "The sky turns red as the Great Eye turns toward us.",
+            "The Witch King comes to claim Gondor.",
+            "This is our final stand.",
+            "YOU SHALL NOT PASS!"
+        };
+        levels.push_back(lvl);
+    }
+
+    /* HORDE :
+     Stress level: five roads feed one long trunk road, and the waves are tens of thousands strong,
+     spawned many per frame. The castle cannot fall here; enemies that reach it are only counted.
+     The same level is what the headless benchmark runs (see Benchmark.h).*/
+    {
+        LevelData lvl; lvl.levelID = 4; lvl.name = "Horde (stress test)";
+        lvl.background = { 0 }; lvl.backgroundPath = "assets/sprites/environment/lvl3_bg.png";
+        lvl.music = { { "music_level3", "assets/sounds/music_level3.mp3" } };
+        lvl.bgColor = DARKGREEN;
+        lvl.startGold = 5000;
+        lvl.horde = true;
+        int width = 50; lvl.cols = width; lvl.mapWidth = width * TILE_SIZE;
+        lvl.castlePos = { 2700.0f, 90.0f }; lvl.castleScale = 0.5f;
+        int design[12][50] = {
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {2,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {2,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,3,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {2,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
+            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
+        };
+        lvl.tileMap.resize(MAP_ROWS);
+        for (int y = 0; y < MAP_ROWS; y++) { lvl.tileMap[y].resize(width); for (int x = 0; x < width; x++) lvl.tileMap[y][x] = design[y][x]; }
+        lvl.paths = GeneratePathsFromMap(lvl.tileMap);
+
+        // 5,000 Orcs per second: the whole first wave is on the road before the first of them reaches the castle.
+        lvl.waves.push_back({ 60000, EnemyType::ORC, 0.0002f, 1.0f, 0 });
+        lvl.waves.push_back({ 20000, EnemyType::URUK, 0.0005f, 1.0f, 0 });
+        lvl.waves.push_back({ 5000, EnemyType::TROLL, 0.002f, 1.0f, 0 });
+        lvl.waves.push_back({ 20, EnemyType::GROND, 0.5f, 1.0f, 0 });
+
+        lvl.storyLines = {
+            "HORDE",
+            "All of Mordor is on the march."
+        };
+        levels.push_back(lvl);
+    }
+    /* ENDLESS :
+     Level 3's roads with no wave list: waves come from GenerateEndlessWave() until the castle falls.*/
+    {
+        LevelData lvl; lvl.levelID = 5; lvl.name = "Endless";
+        lvl.background = { 0 }; lvl.backgroundPath = "assets/sprites/environment/lvl3_bg.png";
+        lvl.music = { { "music_level3", "assets/sounds/music_level3.mp3" }, { "music_boss", "assets/sounds/nazgul_boss.mp3" } };
+        lvl.bgColor = DARKGREEN;
+        lvl.startGold = 700;
+        lvl.endless = true;
+        const LevelData& siege = levels[2];
+        lvl.cols = siege.cols; lvl.mapWidth = siege.mapWidth;
+        lvl.castlePos = siege.castlePos; lvl.castleScale = siege.castleScale;
+        lvl.tileMap = siege.tileMap;
+        lvl.paths = GeneratePathsFromMap(lvl.tileMap);
+
+        lvl.storyLines = {
+            "ENDLESS",
+            "The armies of Mordor have no end.",
+            "Hold as long as you can."
+        };
+        levels.push_back(lvl);
+    }
+    return levels;
+}
+
+/* ENDLESS WAVE CURVE :
+ Wave 'index' is a pure function of (seed, index): a throwaway Rng seeded from both picks the enemy type
+ and a little jitter, and the curve below sets the rest. Nothing is kept between waves, so memory stays
+ flat however long a run lasts, and any wave can be regenerated later from the same two numbers.
+ Enemy kinds unlock over the first waves; counts grow linearly up to a cap, health grows 7% per wave
+ (capped so it cannot overflow), and spawns get denser and faster. Every 10th wave is Grond, every
+ 30th the Witch King.*/
+EnemyWave GenerateEndlessWave(unsigned long long seed, int index) {
+    struct Kind { EnemyType type; int count; float interval; int baseHealth; };
+    static const Kind kinds[] = {
+        { EnemyType::ORC,       10, 1.0f,  20 },
+        { EnemyType::URUK,       6, 1.3f,  50 },
+        { EnemyType::COMMANDER,  2, 2.0f, 600 },
+        { EnemyType::TROLL,      2, 3.5f, 300 },
+    };
+    Rng rng;
+    rng.Seed(seed ^ (0x9E3779B97F4A7C15ULL * (unsigned long long)(index + 1)));
+
+    int number = index + 1;
+    float growth = powf(1.07f, (float)index);
+    float speed = 1.0f + fminf(0.5f, index * 0.01f);
+    if (number % 30 == 0) return { 1, EnemyType::NAZGUL, 5.0f, speed, (int)fminf(2500.0f * (growth - 1.0f), 1000000.0f) };
+    if (number % 10 == 0) return { (int)fminf(1.0f + number / 20, 10.0f), EnemyType::GROND, 5.0f, 1.0f, (int)fminf(1000.0f * (growth - 1.0f), 1000000.0f) };
+
+    int unlocked = (index < 3) ? 1 : (index < 6) ? 2 : (index < 12) ? 3 : 4;
+    const Kind& k = kinds[rng.Range(0, unlocked - 1)];
+    EnemyWave w;
+    w.enemyType = k.type;
+    w.enemyCount = (int)fminf(k.count * (1.0f + index * 0.15f), k.count * 40.0f);
+    w.spawnInterval = k.interval * fmaxf(0.35f, 1.0f - index * 0.02f) * (0.9f + 0.2f * rng.Float());
+    w.speedMultiplier = speed;
+    w.healthBonus = (int)fminf(k.baseHealth * (growth - 1.0f), 1000000.0f);
+    return w;
+}
+
+bool GetLevelWave(const LevelData& level, unsigned long long seed, int index, EnemyWave& out) {
+    if (level.endless) { out = GenerateEndlessWave(seed, index); return true; }
+    if (index < 0 || index >= (int)level.waves.size()) return false;
+    out = level.waves[index];
+    return true;
+}
+
+void DestroyLevels(std::vector<LevelData>& levels) {
+    for (LevelData& lvl : levels) {
+        for (std::vector<Vector2>* p : lvl.paths) delete p;
+        lvl.paths.clear();
+    }
+}
@@ -0,0 +1,38 @@
+﻿#include "LevelResources.h"
+#include "Audio.h"
+
+void LevelResources::Prefetch(LevelData& lvl) {
+    if (level == &lvl) return;
+    Release();
+
+    level = &lvl;
+    loader.reset(new AssetLoader());
+    loader->SetArchive(archive);
+    loader->SetTextureCache(textureCache);
+    loader->QueueTexture(&lvl.background, lvl.backgroundPath);
+    for (const LevelTrack& track : lvl.music) loader->QueueMusic(track.name, track.path);
+    // One worker is enough for a background and one or two tracks, and leaves the other cores alone.
+    loader->Start(1);
+}
+
+void LevelResources::Pump(double budgetMs) {
+    if (loader && !loader->IsDone()) loader->UploadPending(budgetMs);
+}
+
+void LevelResources::Acquire() {
+    if (!loader) return;
+    if (!loader->IsDone()) TraceLog(LOG_WARNING, "LEVEL: %s not prefetched in time, waiting for it", level->name);
+    loader->Finish();
+    loader.reset();
+}
+
+void LevelResources::Release() {
+    if (!level) return;
+    // A prefetch still in flight has to land first, its jobs write into the level.
+    if (loader) { loader->Finish(); loader.reset(); }
+
+    if (level->background.id > 0) UnloadTexture(level->background);
+    level->background = { 0 };
+    for (const LevelTrack& track : level->music) Audio::UnloadMusic(track.name);
+    level = nullptr;
+}
@@ -0,0 +1,138 @@
+﻿#include "Particles.h"
+#include "Renderer.h"
+#include <cmath>
+
+ParticleSystem::ParticleSystem() : budget(4000), rngState(0x2545F491u) {
+    for (Pool& pool : pools) {
+        pool.config = { 0 };
+        pool.config.frames = 1;
+        pool.config.frameTime = 0.1f;
+        pool.config.life = 0.5f;
+        pool.config.burst = 1;
+        pool.config.color = WHITE;
+        pool.config.layer = RenderLayer::AIR;
+    }
+}
+
+void ParticleSystem::Configure(EmitterType type, const EmitterConfig& config) {
+    pools[(int)type].config = config;
+}
+
+// xorshift32: cheap, and independent of raylib's generator so effects do not disturb gameplay randomness.
+float ParticleSystem::RandomFloat(float min, float max) {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return min + (max - min) * (float)(rngState & 0xFFFFFF) / 16777215.0f;
+}
+
+int ParticleSystem::Count() const {
+    int total = 0;
+    for (const Pool& pool : pools) total += pool.Size();
+    return total;
+}
+
+/* LEVEL OF DETAIL :
+ Full detail up to half of the budget, then the emission rate falls linearly to zero at the budget.*/
+float ParticleSystem::GetDetailLevel() const {
+    float load = (float)Count() / (float)budget;
+    if (load <= 0.5f) return 1.0f;
+    if (load >= 1.0f) return 0.0f;
+    return (1.0f - load) * 2.0f;
+}
+
+void ParticleSystem::Emit(EmitterType type, Vector2 position, float amount) {
+    Pool& pool = pools[(int)type];
+
+    // Fractional bursts are resolved randomly, so a burst of 1 at 30% detail still spawns 30% of the time.
+    float wanted = pool.config.burst * amount * GetDetailLevel();
+    int count = (int)wanted;
+    if (RandomFloat(0.0f, 1.0f) < wanted - count) count++;
+    int room = budget - Count();
+    if (count > room) count = room;
+
+    for (int i = 0; i < count; i++) {
+        float angle = RandomFloat(0.0f, 2.0f * PI);
+        float speed = RandomFloat(pool.config.speedMin, pool.config.speedMax);
+        pool.posX.push_back(position.x);
+        pool.posY.push_back(position.y);
+        pool.velX.push_back(cosf(angle) * speed);
+        pool.velY.push_back(sinf(angle) * speed);
+        pool.age.push_back(0.0f);
+    }
+}
+
+void ParticleSystem::UpdatePool(Pool& pool, float dt) {
+    int n = pool.Size();
+    if (n == 0) return;
+
+    float* px = pool.posX.data(); float* py = pool.posY.data();
+    float* vx = pool.velX.data(); float* vy = pool.velY.data();
+    float* age = pool.age.data();
+    float gravityStep = pool.config.gravity * dt;
+
+    // Integration: independent element-wise loops without branches, one stream each.
+    for (int i = 0; i < n; i++) px[i] += vx[i] * dt;
+    for (int i = 0; i < n; i++) vy[i] += gravityStep;
+    for (int i = 0; i < n; i++) py[i] += vy[i] * dt;
+    for (int i = 0; i < n; i++) age[i] += dt;
+
+    // Compaction: expired particles are overwritten by the last one, order does not matter for effects.
+    float life = pool.config.life;
+    for (int i = 0; i < n;) {
+        if (age[i] >= life) {
+            n--;
+            px[i] = px[n]; py[i] = py[n]; vx[i] = vx[n]; vy[i] = vy[n]; age[i] = age[n];
+        }
+        else i++;
+    }
+    pool.posX.resize(n); pool.posY.resize(n);
+    pool.velX.resize(n); pool.velY.resize(n);
+    pool.age.resize(n);
+}
+
+void ParticleSystem::Update(float dt) {
+    for (Pool& pool : pools) UpdatePool(pool, dt);
+}
+
+void ParticleSystem::DrawPool(const Pool& pool) {
+    const EmitterConfig& cfg = pool.config;
+    int n = pool.Size();
+    if (n == 0) return;
+
+    if (cfg.texture.id > 0) {
+        float frameWidth = (float)cfg.texture.width / cfg.frames;
+        float frameHeight = (float)cfg.texture.height;
+        float w = (cfg.size > 0.0f) ? cfg.size : frameWidth;
+        float h = (cfg.size > 0.0f) ? cfg.size : frameHeight;
+        for (int i = 0; i < n; i++) {
+            int frame = (int)(pool.age[i] / cfg.frameTime);
+            if (frame >= cfg.frames) frame = cfg.frames - 1;
+            Color tint = cfg.fade ? Fade(cfg.color, 1.0f - pool.age[i] / cfg.life) : cfg.color;
+            Rectangle source = { frame * frameWidth, 0, frameWidth, frameHeight };
+            Rectangle dest = { pool.posX[i], pool.posY[i], w, h };
+            Renderer::DrawTexturePro(cfg.texture, source, dest, { w / 2, h / 2 }, 0.0f, tint);
+        }
+    }
+    else {
+        float size = (cfg.size > 0.0f) ? cfg.size : 4.0f;
+        for (int i = 0; i < n; i++) {
+            Color tint = cfg.fade ? Fade(cfg.color, 1.0f - pool.age[i] / cfg.life) : cfg.color;
+            Renderer::DrawRectangleRec({ pool.posX[i] - size / 2, pool.posY[i] - size / 2, size, size }, tint);
+        }
+    }
+}
+
+void ParticleSystem::Draw(RenderLayer layer) const {
+    for (const Pool& pool : pools) {
+        if (pool.config.layer == layer) DrawPool(pool);
+    }
+}
+
+void ParticleSystem::Clear() {
+    for (Pool& pool : pools) {
+        pool.posX.clear(); pool.posY.clear();
+        pool.velX.clear(); pool.velY.clear();
+        pool.age.clear();
+    }
+}
@@ -1,19 +1,51 @@
 ﻿#pragma once
 #include "raylib.h"
 #include "raymath.h"
+#include "Renderer.h"
+#include "AssetRegistry.h"
+#include "Enemy.h"
 
 enum class ProjectileType {
     ARROW,
     ICE,
-    MELEE
+    MELEE,
+    // Lobbed: flies over the enemies and bursts where it was aimed, damaging everything in 'splashRadius'.
+    BOULDER,
+    // One segment of a chain-lightning bolt, from 'position' to 'position + velocity'. Visual only, like MELEE.
+    LIGHTNING
 };
 
+// Save-state record of a projectile (see Snapshot.h). All fields are 4 bytes wide, so there is no padding.
+struct ProjectileState {
+    Vector2 position;
+    Vector2 velocity;
+    float speed;
+    float rotation;
+    int active;
+    int damage;
+    int type;
+    int currentFrame;
+    float animTimer;
+    float scale;
+    float splashRadius;
+    float flightTime;
+    int targetSlot;
+    unsigned int targetGeneration;
+    float age;
+};
+
+// Homing projectiles give up after this many seconds in the air (a target they keep circling).
+const float HOMING_MAX_AGE = 3.0f;
+
 class Projectile {
 public:
    
-    Projectile(Vector2 start, Vector2 target, int dmg, ProjectileType t, Texture2D tex, float sc = 1.0f)
+    // 'splash' > 0 makes the hit an area hit (see World::Blast()): the blast radius of a boulder, the shatter radius of ice.
+    // A valid 'homing' handle makes an arrow or ice bolt follow that enemy (see Steer()).
+    Projectile(Vector2 start, Vector2 target, int dmg, ProjectileType t, TextureHandle tex, float sc = 1.0f, float splash = 0.0f,
+        EnemyHandle homing = EnemyHandle())
         : position(start), damage(dmg), type(t), texture(tex),
-        active(true), currentFrame(0), animTimer(0.0f), scale(sc) 
+        active(true), currentFrame(0), animTimer(0.0f), scale(sc), splashRadius(splash), flightTime(0.0f), homingTarget(homing), age(0.0f)
     {
         
         if (type == ProjectileType::MELEE) {
@@ -22,20 +54,77 @@ public:
             rotation = 0.0f;
             position = target;
         }
+        else if (type == ProjectileType::LIGHTNING) {
+            speed = 0.0f;
+            velocity = Vector2Subtract(target, start);
+            rotation = 0.0f;
+        }
         else {
-            speed = 500.0f;
+            speed = GetSpeed(type);
             Vector2 dir = Vector2Normalize(Vector2Subtract(target, start));
             velocity = Vector2Scale(dir, speed);
             rotation = atan2(dir.y, dir.x) * RAD2DEG;
+            if (type == ProjectileType::BOULDER) flightTime = Vector2Distance(start, target) / speed;
         }
 
        
-        frameWidth = texture.width / 6;
-        frameHeight = texture.height;
+        frameWidth = texture.Get().width / 6;
+        frameHeight = texture.Get().height;
     }
 
+    Projectile(const ProjectileState& s, TextureHandle tex)
+        : position(s.position), active(s.active != 0), damage(s.damage), type((ProjectileType)s.type),
+        velocity(s.velocity), speed(s.speed), rotation(s.rotation), texture(tex),
+        currentFrame(s.currentFrame), animTimer(s.animTimer), scale(s.scale), splashRadius(s.splashRadius), flightTime(s.flightTime), age(s.age)
+    {
+        homingTarget.slot = s.targetSlot;
+        homingTarget.generation = s.targetGeneration;
+        frameWidth = texture.Get().width / 6;
+        frameHeight = texture.Get().height;
+    }
+
+    ProjectileState GetState() const {
+        ProjectileState s;
+        s.position = position; s.velocity = velocity; s.speed = speed; s.rotation = rotation;
+        s.active = active ? 1 : 0; s.damage = damage; s.type = (int)type;
+        s.currentFrame = currentFrame; s.animTimer = animTimer; s.scale = scale;
+        s.splashRadius = splashRadius; s.flightTime = flightTime;
+        s.targetSlot = homingTarget.slot; s.targetGeneration = homingTarget.generation; s.age = age;
+        return s;
+    }
+
+    /* HOMING :
+     Turns the velocity towards 'targetPos' by at most the turn rate of the type, so a bolt fired at a
+     bad angle swings round in an arc instead of snapping onto the target. Called by the World before
+     Update(), with the position of the enemy 'GetTarget()' resolves to.*/
+    void Steer(Vector2 targetPos, float dt) {
+        Vector2 to = Vector2Subtract(targetPos, position);
+        if (Vector2LengthSqr(to) < 1e-6f) return;
+        float turnRate = (type == ProjectileType::ICE ? 360.0f : 540.0f) * DEG2RAD;
+        float heading = atan2f(velocity.y, velocity.x);
+        float turn = atan2f(to.y, to.x) - heading;
+        while (turn > PI) turn -= 2.0f * PI;
+        while (turn < -PI) turn += 2.0f * PI;
+        float maxTurn = turnRate * dt;
+        if (turn > maxTurn) turn = maxTurn; else if (turn < -maxTurn) turn = -maxTurn;
+        heading += turn;
+        velocity = { cosf(heading) * speed, sinf(heading) * speed };
+        rotation = heading * RAD2DEG;
+    }
+
+    bool IsHoming() const { return homingTarget.slot >= 0; }
+    EnemyHandle GetTarget() const { return homingTarget; }
+    float GetAge() const { return age; }
+
     void Update(float dt) {
-        if (type != ProjectileType::MELEE) {
+        age += dt;
+        if (type == ProjectileType::BOULDER) {
+            // Stops exactly on the aim point; World::UpdateProjectiles() bursts it there.
+            float step = (dt < flightTime) ? dt : flightTime;
+            position = Vector2Add(position, Vector2Scale(velocity, step));
+            flightTime -= step;
+        }
+        else if (type == ProjectileType::ARROW || type == ProjectileType::ICE) {
             position = Vector2Add(position, Vector2Scale(velocity, dt));
             if (position.x < -100 || position.x > 5000 || position.y < -100 || position.y > 5000) active = false;
         }
@@ -45,7 +134,7 @@ public:
             animTimer = 0.0f;
             currentFrame++;
 
-            if (type == ProjectileType::MELEE && currentFrame >= 6) {
+            if ((type == ProjectileType::MELEE || type == ProjectileType::LIGHTNING) && currentFrame >= 6) {
                 active = false;
             }
             else if (currentFrame >= 6) {
@@ -54,8 +143,29 @@ public:
         }
     }
 
+    // Flight speed in pixels per second; 0 for the hitscan types.
+    static float GetSpeed(ProjectileType t) {
+        if (t == ProjectileType::BOULDER) return 350.0f;
+        if (t == ProjectileType::ARROW || t == ProjectileType::ICE) return 500.0f;
+        return 0.0f;
+    }
+    float GetSplashRadius() const { return splashRadius; }
+    bool HasLanded() const { return type == ProjectileType::BOULDER && flightTime <= 0.0f; }
+
     void Draw() const {
         if (!active) return;
+        if (type == ProjectileType::LIGHTNING) {
+            float fade = 1.0f - currentFrame / 6.0f;
+            Vector2 end = Vector2Add(position, velocity);
+            Renderer::DrawLineEx(position, end, 5.0f, Fade(SKYBLUE, 0.6f * fade));
+            Renderer::DrawLineEx(position, end, 2.0f, Fade(WHITE, fade));
+            return;
+        }
+        if (frameWidth == 0) {
+            // No sprite (the boulder has none): a stone.
+            Renderer::DrawCircleV(position, 6.0f, DARKGRAY);
+            return;
+        }
 
         Rectangle source = { (float)currentFrame * frameWidth, 0, (float)frameWidth, (float)frameHeight };
 
@@ -69,7 +179,7 @@ public:
         
         Vector2 origin = { destW / 2, destH / 2 };
 
-        DrawTexturePro(texture, source, dest, origin, rotation, WHITE);
+        Renderer::DrawTexturePro(texture.Get(), source, dest, origin, rotation, WHITE);
     }
 
     Vector2 position;
@@ -81,9 +191,13 @@ private:
     Vector2 velocity;
     float speed;
     float rotation;
-    Texture2D texture;
+    TextureRef texture;
     int frameWidth, frameHeight, currentFrame;
     float animTimer;
 
     float scale; 
+    float splashRadius;
+    float flightTime;   // Boulders: seconds until they land.
+    EnemyHandle homingTarget;
+    float age;          // Seconds since fired.
 };
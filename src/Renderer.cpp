@@ -0,0 +1,379 @@
+﻿#include "Renderer.h"
+#include "raymath.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+RenderBackend Renderer::backend = RenderBackend::RAYLIB;
+std::vector<DrawCommand> Renderer::commands;
+std::vector<char> Renderer::textBuffer;
+std::vector<unsigned int> Renderer::seenTextures;
+RenderStats Renderer::stats = { 0 };
+RenderStats Renderer::lastStats = { 0 };
+unsigned int Renderer::lastTextureId = 0;
+double Renderer::frameStart = 0.0;
+
+// Pseudo texture id used for batch accounting. In raylib 5.5 shapes sample a white rectangle inside the
+// default font's texture, so shapes and text of the default font share one texture and never break a batch
+// between them.
+static const unsigned int SHAPES_TEXTURE_ID = 0;
+static const unsigned int FONT_TEXTURE_ID = SHAPES_TEXTURE_ID;
+
+static double NowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Renderer::SetBackend(RenderBackend newBackend) {
+    backend = newBackend;
+    commands.clear();
+    textBuffer.clear();
+}
+
+void Renderer::BeginFrame() {
+    commands.clear();
+    textBuffer.clear();
+    seenTextures.clear();
+    stats = { 0 };
+    lastTextureId = SHAPES_TEXTURE_ID;
+    frameStart = NowMs();
+}
+
+void Renderer::EndFrame() {
+    stats.uniqueTextures = (int)seenTextures.size();
+    stats.cpuMs = NowMs() - frameStart;
+    lastStats = stats;
+}
+
+/* BATCH ACCOUNTING :
+ raylib collects geometry into one vertex batch and only flushes it when the bound texture changes,
+ or when the projection/target/blend state changes (Mode2D, TextureMode, BlendMode).
+ Every such flush is counted as a batch break, so the numbers match what the GPU actually receives.
+ Shapes and default-font text count as one texture (see SHAPES_TEXTURE_ID); entering and leaving a
+ render texture are breaks of their own.*/
+void Renderer::CountState(DrawCommandType type, unsigned int textureId) {
+    if (type == DrawCommandType::CLEAR) return;
+    if (type == DrawCommandType::BEGIN_MODE2D || type == DrawCommandType::END_MODE2D ||
+        type == DrawCommandType::BEGIN_TARGET || type == DrawCommandType::END_TARGET ||
+        type == DrawCommandType::BLEND_MODE) {
+        stats.batchBreaks++;
+        return;
+    }
+
+    stats.drawCalls++;
+    if (type == DrawCommandType::TEXT) stats.textCalls++;
+    if (textureId != lastTextureId) {
+        stats.textureSwitches++;
+        stats.batchBreaks++;
+        lastTextureId = textureId;
+    }
+    if (std::find(seenTextures.begin(), seenTextures.end(), textureId) == seenTextures.end()) seenTextures.push_back(textureId);
+}
+
+void Renderer::Record(const DrawCommand& cmd) {
+    CountState(cmd.type, cmd.textureId);
+    if (backend == RenderBackend::RECORDER) commands.push_back(cmd);
+}
+
+static DrawCommand MakeCommand(DrawCommandType type, unsigned int textureId, Rectangle dest, Color color) {
+    DrawCommand cmd = {};
+    cmd.type = type;
+    cmd.textureId = textureId;
+    cmd.dest = dest;
+    cmd.color = color;
+    return cmd;
+}
+
+void Renderer::ClearBackground(Color color) {
+    Record(MakeCommand(DrawCommandType::CLEAR, SHAPES_TEXTURE_ID, { 0, 0, 0, 0 }, color));
+    if (backend == RenderBackend::RAYLIB) ::ClearBackground(color);
+}
+
+void Renderer::BeginMode2D(Camera2D camera) {
+    DrawCommand cmd = MakeCommand(DrawCommandType::BEGIN_MODE2D, SHAPES_TEXTURE_ID, { 0, 0, 0, 0 }, BLANK);
+    cmd.camera = camera;
+    Record(cmd);
+    if (backend == RenderBackend::RAYLIB) ::BeginMode2D(camera);
+}
+
+void Renderer::EndMode2D() {
+    Record(MakeCommand(DrawCommandType::END_MODE2D, SHAPES_TEXTURE_ID, { 0, 0, 0, 0 }, BLANK));
+    if (backend == RenderBackend::RAYLIB) ::EndMode2D();
+}
+
+void Renderer::BeginTextureMode(RenderTexture2D target) {
+    Record(MakeCommand(DrawCommandType::BEGIN_TARGET, target.texture.id, { 0, 0, (float)target.texture.width, (float)target.texture.height }, BLANK));
+    if (backend == RenderBackend::RAYLIB) ::BeginTextureMode(target);
+}
+
+void Renderer::EndTextureMode() {
+    Record(MakeCommand(DrawCommandType::END_TARGET, SHAPES_TEXTURE_ID, { 0, 0, 0, 0 }, BLANK));
+    if (backend == RenderBackend::RAYLIB) ::EndTextureMode();
+}
+
+void Renderer::BeginBlendMode(int mode) {
+    DrawCommand cmd = MakeCommand(DrawCommandType::BLEND_MODE, SHAPES_TEXTURE_ID, { 0, 0, 0, 0 }, BLANK);
+    cmd.blendMode = mode;
+    Record(cmd);
+    if (backend == RenderBackend::RAYLIB) ::BeginBlendMode(mode);
+}
+
+void Renderer::EndBlendMode() {
+    DrawCommand cmd = MakeCommand(DrawCommandType::BLEND_MODE, SHAPES_TEXTURE_ID, { 0, 0, 0, 0 }, BLANK);
+    cmd.blendMode = BLEND_ALPHA;
+    Record(cmd);
+    if (backend == RenderBackend::RAYLIB) ::EndBlendMode();
+}
+
+void Renderer::DrawTexturePro(Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) {
+    DrawCommand cmd = MakeCommand(DrawCommandType::TEXTURE, texture.id, dest, tint);
+    cmd.source = source;
+    cmd.origin = origin;
+    cmd.rotation = rotation;
+    Record(cmd);
+    if (backend == RenderBackend::RAYLIB) ::DrawTexturePro(texture, source, dest, origin, rotation, tint);
+}
+
+void Renderer::DrawRectangle(int posX, int posY, int width, int height, Color color) {
+    Record(MakeCommand(DrawCommandType::RECTANGLE, SHAPES_TEXTURE_ID, { (float)posX, (float)posY, (float)width, (float)height }, color));
+    if (backend == RenderBackend::RAYLIB) ::DrawRectangle(posX, posY, width, height, color);
+}
+
+void Renderer::DrawRectangleRec(Rectangle rec, Color color) {
+    Record(MakeCommand(DrawCommandType::RECTANGLE, SHAPES_TEXTURE_ID, rec, color));
+    if (backend == RenderBackend::RAYLIB) ::DrawRectangleRec(rec, color);
+}
+
+void Renderer::DrawRectangleLines(int posX, int posY, int width, int height, Color color) {
+    DrawCommand cmd = MakeCommand(DrawCommandType::RECTANGLE_LINES, SHAPES_TEXTURE_ID, { (float)posX, (float)posY, (float)width, (float)height }, color);
+    cmd.rotation = 1.0f;
+    Record(cmd);
+    if (backend == RenderBackend::RAYLIB) ::DrawRectangleLines(posX, posY, width, height, color);
+}
+
+void Renderer::DrawRectangleLinesEx(Rectangle rec, float lineThick, Color color) {
+    DrawCommand cmd = MakeCommand(DrawCommandType::RECTANGLE_LINES, SHAPES_TEXTURE_ID, rec, color);
+    cmd.rotation = lineThick;
+    Record(cmd);
+    if (backend == RenderBackend::RAYLIB) ::DrawRectangleLinesEx(rec, lineThick, color);
+}
+
+void Renderer::DrawRectangleGradientV(int posX, int posY, int width, int height, Color top, Color bottom) {
+    DrawCommand cmd = MakeCommand(DrawCommandType::RECTANGLE_GRADIENT, SHAPES_TEXTURE_ID, { (float)posX, (float)posY, (float)width, (float)height }, top);
+    cmd.color2 = bottom;
+    Record(cmd);
+    if (backend == RenderBackend::RAYLIB) ::DrawRectangleGradientV(posX, posY, width, height, top, bottom);
+}
+
+void Renderer::DrawCircleV(Vector2 center, float radius, Color color) {
+    DrawCommand cmd = MakeCommand(DrawCommandType::CIRCLE, SHAPES_TEXTURE_ID, { center.x, center.y, 0, 0 }, color);
+    cmd.rotation = radius;
+    Record(cmd);
+    if (backend == RenderBackend::RAYLIB) ::DrawCircleV(center, radius, color);
+}
+
+void Renderer::DrawCircleLines(int centerX, int centerY, float radius, Color color) {
+    DrawCommand cmd = MakeCommand(DrawCommandType::CIRCLE_LINES, SHAPES_TEXTURE_ID, { (float)centerX, (float)centerY, 0, 0 }, color);
+    cmd.rotation = radius;
+    Record(cmd);
+    if (backend == RenderBackend::RAYLIB) ::DrawCircleLines(centerX, centerY, radius, color);
+}
+
+void Renderer::DrawLineEx(Vector2 start, Vector2 end, float thick, Color color) {
+    DrawCommand cmd = MakeCommand(DrawCommandType::LINE, SHAPES_TEXTURE_ID, { start.x, start.y, end.x, end.y }, color);
+    cmd.rotation = thick;
+    Record(cmd);
+    if (backend == RenderBackend::RAYLIB) ::DrawLineEx(start, end, thick, color);
+}
+
+void Renderer::RecordText(const char* text, int posX, int posY, int fontSize, Color color) {
+    DrawCommand cmd = MakeCommand(DrawCommandType::TEXT, FONT_TEXTURE_ID, { (float)posX, (float)posY, 0, (float)fontSize }, color);
+    cmd.fontSize = fontSize;
+    if (backend == RenderBackend::RECORDER) {
+        /* TEXT STORAGE :
+         Strings are copied into one frame-wide char buffer instead of a std::string per command,
+         because most of them come from TextFormat() whose static buffer is overwritten on the next call.*/
+        size_t len = strlen(text);
+        cmd.textOffset = (int)textBuffer.size();
+        textBuffer.insert(textBuffer.end(), text, text + len + 1);
+        cmd.dest.width = (float)(len * fontSize) * 0.5f;
+    }
+    Record(cmd);
+}
+
+void Renderer::DrawText(const char* text, int posX, int posY, int fontSize, Color color) {
+    RecordText(text, posX, posY, fontSize, color);
+    if (backend == RenderBackend::RAYLIB) ::DrawText(text, posX, posY, fontSize, color);
+}
+
+void Renderer::DrawGlyphRun(const char* text, Texture2D font, const GlyphQuad* glyphs, int count, int posX, int posY, int fontSize, Color color) {
+    RecordText(text, posX, posY, fontSize, color);
+    if (backend != RenderBackend::RAYLIB) return;
+    for (int i = 0; i < count; i++) {
+        Rectangle dest = { glyphs[i].dest.x + posX, glyphs[i].dest.y + posY, glyphs[i].dest.width, glyphs[i].dest.height };
+        ::DrawTexturePro(font, glyphs[i].source, dest, { 0, 0 }, 0.0f, color);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Software rasterizer
+// ---------------------------------------------------------------------------------------------
+
+static Color TextureColor(unsigned int id) {
+    unsigned int h = id * 2654435761u;
+    return Color{ (unsigned char)(h >> 24), (unsigned char)(h >> 16), (unsigned char)(h >> 8), 255 };
+}
+
+static Color Modulate(Color a, Color b) {
+    return Color{ (unsigned char)(a.r * b.r / 255), (unsigned char)(a.g * b.g / 255), (unsigned char)(a.b * b.b / 255), (unsigned char)(a.a * b.a / 255) };
+}
+
+static inline void BlendPixel(unsigned char* px, Color c) {
+    int a = c.a;
+    px[0] = (unsigned char)((c.r * a + px[0] * (255 - a)) / 255);
+    px[1] = (unsigned char)((c.g * a + px[1] * (255 - a)) / 255);
+    px[2] = (unsigned char)((c.b * a + px[2] * (255 - a)) / 255);
+    px[3] = (unsigned char)(a + px[3] * (255 - a) / 255);
+}
+
+/* QUAD RASTERIZATION :
+ Fills a convex quad (corners in clockwise or counter-clockwise order) by testing pixel centers
+ inside its bounding box against the four edge functions. Rotated sprites end up here as well.*/
+static void FillQuad(Image& canvas, const Vector2 p[4], Color color) {
+    if (color.a == 0) return;
+    float minX = p[0].x, maxX = p[0].x, minY = p[0].y, maxY = p[0].y;
+    for (int i = 1; i < 4; i++) {
+        minX = fminf(minX, p[i].x); maxX = fmaxf(maxX, p[i].x);
+        minY = fminf(minY, p[i].y); maxY = fmaxf(maxY, p[i].y);
+    }
+    int x0 = std::max(0, (int)floorf(minX)), x1 = std::min(canvas.width - 1, (int)ceilf(maxX));
+    int y0 = std::max(0, (int)floorf(minY)), y1 = std::min(canvas.height - 1, (int)ceilf(maxY));
+    if (x0 > x1 || y0 > y1) return;
+
+    float area = 0.0f;
+    for (int i = 0; i < 4; i++) { const Vector2& a = p[i]; const Vector2& b = p[(i + 1) % 4]; area += a.x * b.y - b.x * a.y; }
+    float sign = (area >= 0.0f) ? 1.0f : -1.0f;
+
+    unsigned char* pixels = (unsigned char*)canvas.data;
+    for (int y = y0; y <= y1; y++) {
+        float py = y + 0.5f;
+        for (int x = x0; x <= x1; x++) {
+            float px = x + 0.5f;
+            bool inside = true;
+            for (int i = 0; i < 4 && inside; i++) {
+                const Vector2& a = p[i]; const Vector2& b = p[(i + 1) % 4];
+                if (sign * ((b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x)) < 0.0f) inside = false;
+            }
+            if (inside) BlendPixel(&pixels[(y * canvas.width + x) * 4], color);
+        }
+    }
+}
+
+static void FillRect(Image& canvas, Rectangle r, Color color, const Camera2D* camera) {
+    Vector2 p[4] = { { r.x, r.y }, { r.x + r.width, r.y }, { r.x + r.width, r.y + r.height }, { r.x, r.y + r.height } };
+    if (camera) for (Vector2& v : p) v = GetWorldToScreen2D(v, *camera);
+    FillQuad(canvas, p, color);
+}
+
+static void FillCircle(Image& canvas, Vector2 center, float radius, Color color, const Camera2D* camera, bool outline) {
+    if (camera) { center = GetWorldToScreen2D(center, *camera); radius *= camera->zoom; }
+    int y0 = std::max(0, (int)(center.y - radius)), y1 = std::min(canvas.height - 1, (int)(center.y + radius));
+    unsigned char* pixels = (unsigned char*)canvas.data;
+    for (int y = y0; y <= y1; y++) {
+        float dy = y + 0.5f - center.y;
+        float half = sqrtf(fmaxf(radius * radius - dy * dy, 0.0f));
+        int x0 = std::max(0, (int)(center.x - half)), x1 = std::min(canvas.width - 1, (int)(center.x + half));
+        if (outline) {
+            if (x0 < canvas.width && x0 >= 0) BlendPixel(&pixels[(y * canvas.width + x0) * 4], color);
+            if (x1 >= 0 && x1 != x0) BlendPixel(&pixels[(y * canvas.width + x1) * 4], color);
+            continue;
+        }
+        for (int x = x0; x <= x1; x++) BlendPixel(&pixels[(y * canvas.width + x) * 4], color);
+    }
+}
+
+void Renderer::Replay(Image& canvas) {
+    if (canvas.data == nullptr || canvas.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) return;
+
+    Camera2D camera = { 0 };
+    bool inMode2D = false;
+    const Camera2D* cam = nullptr;
+
+    for (const DrawCommand& cmd : commands) {
+        cam = inMode2D ? &camera : nullptr;
+        switch (cmd.type) {
+        case DrawCommandType::CLEAR:
+        {
+            unsigned char* pixels = (unsigned char*)canvas.data;
+            for (int i = 0; i < canvas.width * canvas.height; i++) memcpy(&pixels[i * 4], &cmd.color, 4);
+        }
+        break;
+        case DrawCommandType::BEGIN_MODE2D: camera = cmd.camera; inMode2D = true; break;
+        case DrawCommandType::END_MODE2D: inMode2D = false; break;
+        // Already counted as batch breaks when recorded. The canvas has no render textures, so what is
+        // drawn into one lands on the canvas directly.
+        case DrawCommandType::BEGIN_TARGET:
+        case DrawCommandType::END_TARGET:
+        case DrawCommandType::BLEND_MODE:
+            break;
+        case DrawCommandType::TEXTURE:
+        {
+            /* Same corner math as raylib's DrawTexturePro: rotate the destination quad around 'origin'. */
+            float s = sinf(cmd.rotation * DEG2RAD), c = cosf(cmd.rotation * DEG2RAD);
+            float dx = -cmd.origin.x, dy = -cmd.origin.y;
+            float w = cmd.dest.width, h = cmd.dest.height;
+            Vector2 local[4] = { { dx, dy }, { dx + w, dy }, { dx + w, dy + h }, { dx, dy + h } };
+            Vector2 p[4];
+            for (int i = 0; i < 4; i++) {
+                p[i] = { cmd.dest.x + local[i].x * c - local[i].y * s, cmd.dest.y + local[i].x * s + local[i].y * c };
+                if (cam) p[i] = GetWorldToScreen2D(p[i], *cam);
+            }
+            FillQuad(canvas, p, Modulate(TextureColor(cmd.textureId), cmd.color));
+        }
+        break;
+        case DrawCommandType::RECTANGLE:
+            FillRect(canvas, cmd.dest, cmd.color, cam);
+            break;
+        case DrawCommandType::RECTANGLE_GRADIENT:
+        {
+            Rectangle top = { cmd.dest.x, cmd.dest.y, cmd.dest.width, cmd.dest.height / 2 };
+            Rectangle bottom = { cmd.dest.x, cmd.dest.y + cmd.dest.height / 2, cmd.dest.width, cmd.dest.height / 2 };
+            FillRect(canvas, top, cmd.color, cam);
+            FillRect(canvas, bottom, cmd.color2, cam);
+        }
+        break;
+        case DrawCommandType::RECTANGLE_LINES:
+        {
+            const Rectangle& r = cmd.dest; float t = cmd.rotation;
+            FillRect(canvas, { r.x, r.y, r.width, t }, cmd.color, cam);
+            FillRect(canvas, { r.x, r.y + r.height - t, r.width, t }, cmd.color, cam);
+            FillRect(canvas, { r.x, r.y + t, t, r.height - 2 * t }, cmd.color, cam);
+            FillRect(canvas, { r.x + r.width - t, r.y + t, t, r.height - 2 * t }, cmd.color, cam);
+        }
+        break;
+        case DrawCommandType::CIRCLE:
+            FillCircle(canvas, { cmd.dest.x, cmd.dest.y }, cmd.rotation, cmd.color, cam, false);
+            break;
+        case DrawCommandType::CIRCLE_LINES:
+            FillCircle(canvas, { cmd.dest.x, cmd.dest.y }, cmd.rotation, cmd.color, cam, true);
+            break;
+        case DrawCommandType::LINE:
+        {
+            // A quad 'rotation' pixels wide around the segment.
+            Vector2 a = { cmd.dest.x, cmd.dest.y }, b = { cmd.dest.width, cmd.dest.height };
+            float dx = b.x - a.x, dy = b.y - a.y;
+            float len = sqrtf(dx * dx + dy * dy);
+            if (len <= 0.0f) break;
+            float nx = -dy / len * cmd.rotation * 0.5f, ny = dx / len * cmd.rotation * 0.5f;
+            Vector2 p[4] = { { a.x + nx, a.y + ny }, { b.x + nx, b.y + ny }, { b.x - nx, b.y - ny }, { a.x - nx, a.y - ny } };
+            if (cam) for (Vector2& v : p) v = GetWorldToScreen2D(v, *cam);
+            FillQuad(canvas, p, cmd.color);
+        }
+        break;
+        case DrawCommandType::TEXT:
+            FillRect(canvas, { cmd.dest.x, cmd.dest.y, cmd.dest.width, (float)cmd.fontSize }, cmd.color, cam);
+            break;
+        }
+    }
+}
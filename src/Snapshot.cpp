@@ -0,0 +1,232 @@
+﻿#include "Snapshot.h"
+#include "World.h"
+#include <cstdio>
+#include <cstring>
+
+// Each record is memcpy'd as-is; a padding byte would make snapshots depend on uninitialized memory.
+static_assert(sizeof(SnapshotHeader) == 9 * 4, "SnapshotHeader must not contain padding");
+static_assert(sizeof(WorldSnapshotState) == 2 * 8 + 14 * 4, "WorldSnapshotState must not contain padding");
+static_assert(sizeof(EnemyState) == 17 * 4, "EnemyState must not contain padding");
+static_assert(sizeof(TowerState) == 10 * 4, "TowerState must not contain padding");
+static_assert(sizeof(ProjectileState) == 17 * 4, "ProjectileState must not contain padding");
+static_assert(sizeof(RiderState) == 7 * 4, "RiderState must not contain padding");
+static_assert(sizeof(EffectState) == 8 * 4, "EffectState must not contain padding");
+
+// Projectiles do not remember who fired them; their sprite follows from their type.
+static TowerType ShooterOf(ProjectileType type) {
+    if (type == ProjectileType::ICE) return TowerType::ICE;
+    if (type == ProjectileType::MELEE) return TowerType::MELEE;
+    if (type == ProjectileType::BOULDER) return TowerType::CATAPULT;
+    if (type == ProjectileType::LIGHTNING) return TowerType::LIGHTNING;
+    return TowerType::ARCHER;
+}
+
+void World::SaveSnapshot(std::vector<unsigned char>& out) const {
+    SnapshotHeader header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.levelID = level ? level->levelID : 0;
+    header.enemyCount = (int)enemies.size();
+    header.towerCount = (int)towers.size();
+    header.projectileCount = (int)projectiles.size();
+    header.riderCount = (int)riders.size();
+    header.effectCount = effects.Count();
+    size_t size = sizeof(SnapshotHeader) + sizeof(WorldSnapshotState) + enemies.size() * sizeof(EnemyState) +
+        towers.size() * sizeof(TowerState) + projectiles.size() * sizeof(ProjectileState) + riders.size() * sizeof(RiderState) +
+        (size_t)header.effectCount * sizeof(EffectState);
+    header.size = (unsigned int)size;
+
+    WorldSnapshotState w;
+    w.rngState = rng.state; w.waveSeed = waveSeed;
+    w.gold = gold; w.urukBlood = urukBlood; w.castleHealth = castleHealth;
+    w.currentWaveIndex = currentWaveIndex; w.enemiesSpawnedInWave = enemiesSpawnedInWave;
+    w.spawnTimer = spawnTimer; w.waveDelayTimer = waveDelayTimer; w.walkSoundTimer = walkSoundTimer;
+    w.isBossActive = isBossActive ? 1 : 0; w.castleInvulnerable = castleInvulnerable ? 1 : 0; w.outcome = (int)outcome;
+    w.totalSpawned = totalSpawned; w.totalKilled = totalKilled; w.totalLeaked = totalLeaked;
+
+    out.resize(size);
+    unsigned char* p = out.data();
+    memcpy(p, &header, sizeof(header)); p += sizeof(header);
+    memcpy(p, &w, sizeof(w)); p += sizeof(w);
+    for (const Enemy& e : enemies) {
+        EnemyState s = e.GetState();
+        s.pathIndex = PathIndexOf(e.GetPath());
+        memcpy(p, &s, sizeof(s)); p += sizeof(s);
+    }
+    for (const Tower& t : towers) {
+        TowerState s = t.GetState();
+        memcpy(p, &s, sizeof(s)); p += sizeof(s);
+    }
+    for (const Projectile& pr : projectiles) {
+        ProjectileState s = pr.GetState();
+        memcpy(p, &s, sizeof(s)); p += sizeof(s);
+    }
+    for (const Rohirrim& r : riders) {
+        RiderState s = { r.position, PathIndexOf(r.path), r.currentPoint, r.active ? 1 : 0, r.animTimer, r.currentFrameIndex };
+        memcpy(p, &s, sizeof(s)); p += sizeof(s);
+    }
+    effects.Save(p);
+}
+
+/* LOADING :
+ The whole snapshot is validated before the world is touched: header, sizes, and every index a record
+ carries (types, paths, path positions, handle slots). Records are then read in place with memcpy into
+ a local and the entities are constructed straight into the reserved vectors.
+ The enemy slot table is not saved. It is rebuilt from the enemies' handles; free slots get a
+ generation above every generation in the snapshot, so no saved handle to a removed enemy can resolve
+ to whoever takes its slot next.*/
+bool World::LoadSnapshot(const unsigned char* data, size_t size) {
+    if (!level || size < sizeof(SnapshotHeader) + sizeof(WorldSnapshotState)) return false;
+    SnapshotHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || header.size != size) return false;
+    if (header.levelID != level->levelID) return false;
+    if (header.enemyCount < 0 || header.towerCount < 0 || header.projectileCount < 0 || header.riderCount < 0 || header.effectCount < 0) return false;
+    size_t expected = sizeof(SnapshotHeader) + sizeof(WorldSnapshotState) + (size_t)header.enemyCount * sizeof(EnemyState) +
+        (size_t)header.towerCount * sizeof(TowerState) + (size_t)header.projectileCount * sizeof(ProjectileState) +
+        (size_t)header.riderCount * sizeof(RiderState) + (size_t)header.effectCount * sizeof(EffectState);
+    if (expected != size) return false;
+
+    WorldSnapshotState w;
+    memcpy(&w, data + sizeof(SnapshotHeader), sizeof(w));
+    if (w.outcome < (int)WorldOutcome::RUNNING || w.outcome > (int)WorldOutcome::DEFEAT) return false;
+
+    const unsigned char* enemyData = data + sizeof(SnapshotHeader) + sizeof(WorldSnapshotState);
+    const unsigned char* towerData = enemyData + (size_t)header.enemyCount * sizeof(EnemyState);
+    const unsigned char* projectileData = towerData + (size_t)header.towerCount * sizeof(TowerState);
+    const unsigned char* riderData = projectileData + (size_t)header.projectileCount * sizeof(ProjectileState);
+    const unsigned char* effectData = riderData + (size_t)header.riderCount * sizeof(RiderState);
+    int pathCount = (int)level->paths.size();
+
+    // Every living enemy holds a slot, so there are never more slots than the peak enemy count; a larger
+    // slot number can only come from a corrupt file.
+    const int maxSlot = 1 << 24;
+    int slotCount = 0;
+    unsigned int maxGeneration = 0;
+    for (int i = 0; i < header.enemyCount; i++) {
+        EnemyState s;
+        memcpy(&s, enemyData + i * sizeof(EnemyState), sizeof(s));
+        if (s.type < 0 || s.type >= (int)EnemyType::COUNT || s.pathIndex < 0 || s.pathIndex >= pathCount) return false;
+        if (s.currentPoint < 0 || s.currentPoint >= (int)level->paths[s.pathIndex]->size()) return false;
+        if (s.handleSlot < 0 || s.handleSlot >= maxSlot) return false;
+        if (s.handleSlot >= slotCount) slotCount = s.handleSlot + 1;
+        if (s.handleGeneration > maxGeneration) maxGeneration = s.handleGeneration;
+    }
+    // Effects may still point at enemies that were removed since the last tick. Their slots are counted in so
+    // the rebuilt table hands them out again at a newer generation, which leaves those effects unresolved.
+    for (int i = 0; i < header.effectCount; i++) {
+        EffectState s;
+        memcpy(&s, effectData + i * sizeof(EffectState), sizeof(s));
+        if (s.kind < 0 || s.kind >= (int)EffectKind::COUNT || s.targetSlot < 0 || s.targetSlot >= maxSlot || s.stacks < 1) return false;
+        if (s.targetSlot >= slotCount) slotCount = s.targetSlot + 1;
+        if (s.targetGeneration > maxGeneration) maxGeneration = s.targetGeneration;
+    }
+    // StatusEffects keeps at most one instance per kind and slot.
+    std::vector<unsigned char> seen((size_t)slotCount * (int)EffectKind::COUNT, 0);
+    for (int i = 0; i < header.effectCount; i++) {
+        EffectState s;
+        memcpy(&s, effectData + i * sizeof(EffectState), sizeof(s));
+        unsigned char& mark = seen[(size_t)s.targetSlot * (int)EffectKind::COUNT + s.kind];
+        if (mark) return false;
+        mark = 1;
+    }
+    std::vector<EnemySlot> slots(slotCount, EnemySlot{ -1, 0 });
+    for (int i = 0; i < header.enemyCount; i++) {
+        EnemyState s;
+        memcpy(&s, enemyData + i * sizeof(EnemyState), sizeof(s));
+        if (slots[s.handleSlot].index >= 0) return false;   // Two enemies in one slot.
+        slots[s.handleSlot] = { i, s.handleGeneration };
+    }
+    for (int i = 0; i < header.towerCount; i++) {
+        TowerState s;
+        memcpy(&s, towerData + i * sizeof(TowerState), sizeof(s));
+        if (s.type < 0 || s.type >= (int)TowerType::COUNT) return false;
+    }
+    for (int i = 0; i < header.projectileCount; i++) {
+        ProjectileState s;
+        memcpy(&s, projectileData + i * sizeof(ProjectileState), sizeof(s));
+        if (s.type < 0 || s.type > (int)ProjectileType::LIGHTNING) return false;
+        if (s.targetGeneration > maxGeneration) maxGeneration = s.targetGeneration;
+    }
+    for (int i = 0; i < header.riderCount; i++) {
+        RiderState s;
+        memcpy(&s, riderData + i * sizeof(RiderState), sizeof(s));
+        if (s.pathIndex < 0 || s.pathIndex >= pathCount) return false;
+        if (s.currentPoint < 0 || s.currentPoint >= (int)level->paths[s.pathIndex]->size()) return false;
+        if (riderFrames && (s.currentFrameIndex < 0 || s.currentFrameIndex >= (int)riderFrames->size())) return false;
+    }
+    if (header.riderCount > 0 && !riderFrames) return false;
+
+    rng.state = w.rngState; waveSeed = w.waveSeed;
+    gold = w.gold; urukBlood = w.urukBlood; castleHealth = w.castleHealth;
+    currentWaveIndex = w.currentWaveIndex; enemiesSpawnedInWave = w.enemiesSpawnedInWave;
+    spawnTimer = w.spawnTimer; waveDelayTimer = w.waveDelayTimer; walkSoundTimer = w.walkSoundTimer;
+    isBossActive = w.isBossActive != 0; castleInvulnerable = w.castleInvulnerable != 0; outcome = (WorldOutcome)w.outcome;
+    totalSpawned = w.totalSpawned; totalKilled = w.totalKilled; totalLeaked = w.totalLeaked;
+    hasWave = PeekWave(currentWaveIndex, currentWave);
+    bossSpawned = false;
+
+    freeEnemySlots.clear();
+    for (int slot = slotCount - 1; slot >= 0; slot--) {
+        if (slots[slot].index >= 0) continue;
+        slots[slot].generation = maxGeneration + 1;
+        freeEnemySlots.push_back(slot);
+    }
+    enemySlots.swap(slots);
+
+    enemies.clear();
+    enemies.reserve(header.enemyCount);
+    for (int& n : enemiesByType) n = 0;
+    for (int i = 0; i < header.enemyCount; i++) {
+        EnemyState s;
+        memcpy(&s, enemyData + i * sizeof(EnemyState), sizeof(s));
+        enemies.emplace_back(s, level->paths[s.pathIndex], enemyTextures[s.type]);
+        enemiesByType[s.type]++;
+    }
+    towers.clear();
+    towers.reserve(header.towerCount);
+    for (int i = 0; i < header.towerCount; i++) {
+        TowerState s;
+        memcpy(&s, towerData + i * sizeof(TowerState), sizeof(s));
+        towers.emplace_back(s, towerTextures[s.type], projectileTextures[s.type]);
+    }
+    // Buffs are not saved; they follow from where the banners stand.
+    RebuildSupportList();
+    for (Tower& t : towers) RefreshBuff(t);
+    projectiles.clear();
+    projectiles.reserve(header.projectileCount);
+    for (int i = 0; i < header.projectileCount; i++) {
+        ProjectileState s;
+        memcpy(&s, projectileData + i * sizeof(ProjectileState), sizeof(s));
+        projectiles.emplace_back(s, projectileTextures[(int)ShooterOf((ProjectileType)s.type)]);
+    }
+    riders.clear();
+    riders.reserve(header.riderCount);
+    for (int i = 0; i < header.riderCount; i++) {
+        RiderState s;
+        memcpy(&s, riderData + i * sizeof(RiderState), sizeof(s));
+        riders.emplace_back(s, level->paths[s.pathIndex], riderFrames);
+    }
+    effects.Load(effectData, header.effectCount);
+    effects.Publish(enemies, [this](EnemyHandle h) { return Resolve(h); });
+    return true;
+}
+
+bool WriteSnapshotFile(const char* path, const std::vector<unsigned char>& data) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = data.empty() || fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && ok;
+}
+
+bool ReadSnapshotFile(const char* path, std::vector<unsigned char>& data) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data.resize(length > 0 ? (size_t)length : 0);
+    size_t got = data.empty() ? 0 : fread(data.data(), 1, data.size(), f);
+    fclose(f);
+    return got == data.size();
+}
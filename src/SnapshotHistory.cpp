@@ -0,0 +1,253 @@
+﻿#include "SnapshotHistory.h"
+#include <chrono>
+
+static double NowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void PutVarint(std::vector<unsigned char>& out, size_t value) {
+    while (value >= 0x80) { out.push_back((unsigned char)(value | 0x80)); value >>= 7; }
+    out.push_back((unsigned char)value);
+}
+
+static bool GetVarint(const unsigned char*& p, const unsigned char* end, size_t& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char b = *p++;
+        value |= (size_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+/* DELTA ENCODING :
+ 'cur' XOR 'base' (bytes past the end of 'base' count as XOR with zero), written as alternating
+ (zero run length, literal length, literal bytes) with varint lengths. A keyframe passes an empty base,
+ which degenerates to plain run-length coding of the zeros in the snapshot itself.*/
+static void Encode(const std::vector<unsigned char>& base, const std::vector<unsigned char>& cur, std::vector<unsigned char>& out) {
+    out.clear();
+    size_t n = cur.size();
+    size_t i = 0;
+    auto delta = [&](size_t k) { return (unsigned char)(cur[k] ^ (k < base.size() ? base[k] : 0)); };
+    while (i < n) {
+        size_t zeros = 0;
+        while (i < n && delta(i) == 0) { zeros++; i++; }
+        // A literal run ends at the first zero run long enough to be worth its two length bytes.
+        size_t start = i;
+        while (i < n) {
+            if (delta(i) == 0) {
+                size_t run = 1;
+                while (i + run < n && run < 3 && delta(i + run) == 0) run++;
+                if (run >= 3) break;
+            }
+            i++;
+        }
+        PutVarint(out, zeros);
+        PutVarint(out, i - start);
+        for (size_t k = start; k < i; k++) out.push_back(delta(k));
+    }
+}
+
+static bool DecodeInto(const std::vector<unsigned char>& base, const std::vector<unsigned char>& data, size_t rawSize, std::vector<unsigned char>& out) {
+    out.resize(rawSize);
+    const unsigned char* p = data.data();
+    const unsigned char* end = p + data.size();
+    size_t pos = 0;
+    while (p < end) {
+        size_t zeros, literals;
+        if (!GetVarint(p, end, zeros) || !GetVarint(p, end, literals)) return false;
+        if (pos + zeros + literals > rawSize || literals > (size_t)(end - p)) return false;
+        for (size_t k = 0; k < zeros; k++, pos++) out[pos] = pos < base.size() ? base[pos] : 0;
+        for (size_t k = 0; k < literals; k++, pos++) out[pos] = *p++ ^ (pos < base.size() ? base[pos] : 0);
+    }
+    return pos == rawSize;
+}
+
+SnapshotHistoryConfig HistoryConfigFor(const LevelData& level) {
+    SnapshotHistoryConfig config;
+    config.intervalSeconds = 1.0f;
+    config.historySeconds = 300.0f;
+    config.keyframeEvery = 10;
+    if (level.horde) {
+        config.intervalSeconds = 2.0f;
+        config.historySeconds = 60.0f;
+    }
+    return config;
+}
+
+void SnapshotHistory::Configure(const SnapshotHistoryConfig& newConfig) {
+    config = newConfig;
+    if (config.intervalSeconds <= 0.0f) config.intervalSeconds = 1.0f;
+    if (config.keyframeEvery < 1) config.keyframeEvery = 1;
+    ring.clear();
+    Clear();
+}
+
+void SnapshotHistory::Clear() {
+    head = 0; count = 0; sinceKeyframe = 0;
+    forceKeyframe = true;
+    clock = 0.0; nextCapture = 0.0;
+    lastWave = -1;
+    waveStarts.clear();
+}
+
+void SnapshotHistory::Record(const World& world, float dt) {
+    clock += dt;
+    if (!world.level) return;
+    double start = NowMs();
+
+    if (world.currentWaveIndex != lastWave) {
+        lastWave = world.currentWaveIndex;
+        std::vector<unsigned char> buffer;
+        if ((int)waveStarts.size() >= config.maxWaveStarts && !waveStarts.empty()) {
+            buffer.swap(waveStarts.front().data);
+            waveStarts.erase(waveStarts.begin());
+        }
+        world.SaveSnapshot(buffer);
+        WaveStart ws;
+        ws.wave = world.currentWaveIndex;
+        ws.time = clock;
+        ws.data.swap(buffer);
+        waveStarts.push_back(std::move(ws));
+    }
+    if (count == 0 || clock >= nextCapture) {
+        Push(world);
+        nextCapture = clock + config.intervalSeconds;
+    }
+    TrimToBudget();
+    lastRecordMs = NowMs() - start;
+}
+
+void SnapshotHistory::Push(const World& world) {
+    if (ring.empty()) ring.resize((size_t)(config.historySeconds / config.intervalSeconds) + config.keyframeEvery + 1);
+    if (count == (int)ring.size()) DropOldestGroup();
+
+    world.SaveSnapshot(current);
+    bool keyframe = forceKeyframe || count == 0 || sinceKeyframe + 1 >= config.keyframeEvery;
+    static const std::vector<unsigned char> none;
+    Entry& e = At(count);
+    e.time = clock;
+    e.wave = world.currentWaveIndex;
+    e.keyframe = keyframe;
+    e.rawSize = current.size();
+    Encode(keyframe ? none : previous, current, e.data);
+    count++;
+    sinceKeyframe = keyframe ? 0 : sinceKeyframe + 1;
+    forceKeyframe = false;
+    previous.swap(current);
+}
+
+/* BYTE BUDGET :
+ Reused buffers keep the capacity of the largest entry they ever held, so the budget counts capacity, and
+ whatever is dropped to meet it is released rather than kept for reuse. Spare ring buffers go first,
+ then the wave starts before the newest one, then whole groups from the front of the ring. The newest
+ wave start and the group of the newest entry are always kept, so one group can overshoot the budget.*/
+void SnapshotHistory::TrimToBudget() {
+    size_t held = GetHeldBytes();
+    if (held <= config.maxBytes) return;
+    for (int i = count; i < (int)ring.size(); i++) std::vector<unsigned char>().swap(At(i).data);
+    held = GetHeldBytes();
+    while (held > config.maxBytes && waveStarts.size() > 1) {
+        held -= waveStarts.front().data.capacity();
+        waveStarts.erase(waveStarts.begin());
+    }
+    while (held > config.maxBytes) {
+        int next = 1;
+        while (next < count && !At(next).keyframe) next++;
+        if (next >= count) break;
+        for (int i = 0; i < next; i++) {
+            held -= At(i).data.capacity();
+            std::vector<unsigned char>().swap(At(i).data);
+        }
+        DropOldestGroup();
+    }
+}
+
+size_t SnapshotHistory::GetHeldBytes() const {
+    size_t bytes = previous.capacity() + current.capacity();
+    for (const Entry& e : ring) bytes += e.data.capacity();
+    for (const WaveStart& ws : waveStarts) bytes += ws.data.capacity();
+    return bytes;
+}
+
+size_t SnapshotHistory::GetEncodedBytes() const {
+    size_t bytes = 0;
+    for (int i = 0; i < count; i++) bytes += At(i).data.size();
+    return bytes;
+}
+
+// The entries after a keyframe need it to decode, so the ring only ever starts on a keyframe.
+void SnapshotHistory::DropOldestGroup() {
+    do {
+        head = (head + 1) % (int)ring.size();
+        count--;
+    } while (count > 0 && !At(0).keyframe);
+}
+
+bool SnapshotHistory::Decode(int index, std::vector<unsigned char>& out) {
+    int k = index;
+    while (k > 0 && !At(k).keyframe) k--;
+    static const std::vector<unsigned char> none;
+    if (!DecodeInto(none, At(k).data, At(k).rawSize, out)) return false;
+    for (int i = k + 1; i <= index; i++) {
+        if (!DecodeInto(out, At(i).data, At(i).rawSize, current)) return false;
+        out.swap(current);
+    }
+    return true;
+}
+
+bool SnapshotHistory::Restore(World& world, const std::vector<unsigned char>& raw, double time) {
+    if (!world.LoadSnapshot(raw.data(), raw.size())) return false;
+    clock = time;
+    nextCapture = time + config.intervalSeconds;
+    lastWave = world.currentWaveIndex;
+    // What comes next is a new timeline; start it with a keyframe rather than a delta against the old one.
+    forceKeyframe = true;
+    while (!waveStarts.empty() && waveStarts.back().time > time) waveStarts.pop_back();
+    return true;
+}
+
+float SnapshotHistory::Rewind(World& world, float seconds) {
+    if (count == 0) return -1.0f;
+    double target = clock - seconds;
+    int index = 0;
+    for (int i = count - 1; i >= 0; i--) {
+        if (At(i).time <= target) { index = i; break; }
+    }
+    std::vector<unsigned char> raw;
+    double before = clock;
+    if (!Decode(index, raw) || !Restore(world, raw, At(index).time)) return -1.0f;
+    count = index + 1;
+    return (float)(before - clock);
+}
+
+bool SnapshotHistory::JumpToWave(World& world, int waveIndex) {
+    for (size_t i = 0; i < waveStarts.size(); i++) {
+        if (waveStarts[i].wave != waveIndex) continue;
+        std::vector<unsigned char> raw = waveStarts[i].data;
+        double time = waveStarts[i].time;
+        if (!Restore(world, raw, time)) return false;
+        while (count > 0 && At(count - 1).time > time) count--;
+        return true;
+    }
+    return false;
+}
+
+float SnapshotHistory::GetCoveredSeconds() const {
+    if (count == 0) return 0.0f;
+    return (float)(At(count - 1).time - At(0).time) + config.intervalSeconds;
+}
+
+size_t SnapshotHistory::GetMemoryBytes() const {
+    size_t bytes = ring.capacity() * sizeof(Entry) + previous.capacity() + current.capacity();
+    for (const Entry& e : ring) bytes += e.data.capacity();
+    for (const WaveStart& ws : waveStarts) bytes += sizeof(WaveStart) + ws.data.capacity();
+    return bytes;
+}
+
+float SnapshotHistory::GetBytesPerMinute() const {
+    float covered = GetCoveredSeconds();
+    if (covered <= 0.0f) return 0.0f;
+    return GetEncodedBytes() / covered * 60.0f;
+}
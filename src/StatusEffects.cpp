@@ -0,0 +1,103 @@
+﻿#include "StatusEffects.h"
+#include <algorithm>
+#include <cstring>
+
+void StatusEffects::Clear() {
+    for (int k = 0; k < (int)EffectKind::COUNT; k++) {
+        lists[k].clear();
+        entryOfSlot[k].clear();
+    }
+}
+
+void StatusEffects::Apply(Enemy& enemy, EffectKind kind, float duration, float magnitude) {
+    int k = (int)kind;
+    const EffectRule& rule = rules[k];
+    EnemyHandle h = enemy.GetHandle();
+    if (h.slot < 0 || duration <= 0.0f || !enemy.IsAlive()) return;
+    if (!rule.enabled || (rule.bossesImmune && enemy.IsBoss())) return;
+
+    std::vector<int>& table = entryOfSlot[k];
+    if (h.slot >= (int)table.size()) table.resize(h.slot + 1, -1);
+    Instance fresh = { h, duration, duration, magnitude, 1, 0.0f };
+    int entry = table[h.slot];
+    if (entry < 0) {
+        table[h.slot] = (int)lists[k].size();
+        lists[k].push_back(fresh);
+        return;
+    }
+    Instance& e = lists[k][entry];
+    if (e.target.generation != h.generation) {
+        // Left behind by the enemy that held this slot before and not dropped yet; the newcomer takes it over.
+        e = fresh;
+        return;
+    }
+    if (rule.stacking == EffectStacking::REFRESH) {
+        if (magnitude >= e.magnitude) {
+            e.magnitude = magnitude;
+            e.timeLeft = std::max(e.timeLeft, duration);
+            e.duration = std::max(e.duration, duration);
+        }
+        else if (duration > e.timeLeft) {
+            // A weaker effect that outlasts the current one takes over, so a strong slow does not live on
+            // in the timer of a weak one that keeps being refreshed (the banner aura).
+            e.magnitude = magnitude;
+            e.timeLeft = duration;
+            e.duration = duration;
+        }
+    }
+    else {
+        if (e.stacks < rule.maxStacks) e.stacks++;
+        e.timeLeft = duration;
+        e.duration = duration;
+        e.magnitude = std::max(e.magnitude, magnitude);
+    }
+}
+
+// Swap-with-last, like the enemy list; the slot table follows the instance that moved.
+void StatusEffects::Remove(int kind, size_t i) {
+    std::vector<Instance>& list = lists[kind];
+    std::vector<int>& table = entryOfSlot[kind];
+    table[list[i].target.slot] = -1;
+    if (i + 1 != list.size()) {
+        list[i] = list.back();
+        table[list[i].target.slot] = (int)i;
+    }
+    list.pop_back();
+}
+
+int StatusEffects::Count() const {
+    int count = 0;
+    for (const std::vector<Instance>& list : lists) count += (int)list.size();
+    return count;
+}
+
+size_t StatusEffects::GetMemoryBytes() const {
+    size_t bytes = 0;
+    for (int k = 0; k < (int)EffectKind::COUNT; k++) bytes += lists[k].capacity() * sizeof(Instance) + entryOfSlot[k].capacity() * sizeof(int);
+    return bytes;
+}
+
+void StatusEffects::Save(unsigned char* out) const {
+    for (int k = 0; k < (int)EffectKind::COUNT; k++) {
+        for (const Instance& e : lists[k]) {
+            EffectState s = { k, e.target.slot, e.target.generation, e.timeLeft, e.duration, e.magnitude, e.stacks, e.pending };
+            memcpy(out, &s, sizeof(s));
+            out += sizeof(s);
+        }
+    }
+}
+
+void StatusEffects::Load(const unsigned char* data, int count) {
+    Clear();
+    for (int i = 0; i < count; i++) {
+        EffectState s;
+        memcpy(&s, data + i * sizeof(EffectState), sizeof(s));
+        EnemyHandle h;
+        h.slot = s.targetSlot;
+        h.generation = s.targetGeneration;
+        std::vector<int>& table = entryOfSlot[s.kind];
+        if (h.slot >= (int)table.size()) table.resize(h.slot + 1, -1);
+        table[h.slot] = (int)lists[s.kind].size();
+        lists[s.kind].push_back({ h, s.timeLeft, s.duration, s.magnitude, s.stacks, s.pending });
+    }
+}
@@ -0,0 +1,160 @@
+﻿#include "TextCache.h"
+#include "Renderer.h"
+#include <cstring>
+
+std::list<TextCache::Entry> TextCache::entries;
+std::unordered_map<unsigned long long, std::list<TextCache::Entry>::iterator> TextCache::index;
+int TextCache::capacity = 256;
+int TextCache::hits = 0;
+int TextCache::misses = 0;
+int TextCache::evictions = 0;
+
+// FNV-1a over the string bytes, mixed with the font size so the same text at two sizes gets two entries.
+static unsigned long long HashText(const char* text, int fontSize) {
+    unsigned long long h = 14695981039346656037ULL;
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) { h ^= *p; h *= 1099511628211ULL; }
+    h ^= (unsigned long long)fontSize * 0x9E3779B97F4A7C15ULL;
+    return h;
+}
+
+void TextCache::SetCapacity(int maxEntries) {
+    capacity = (maxEntries < 1) ? 1 : maxEntries;
+    while ((int)entries.size() > capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+        evictions++;
+    }
+}
+
+void TextCache::Clear() {
+    entries.clear();
+    index.clear();
+}
+
+/* LAYOUT :
+ Mirrors raylib's DrawText -> DrawTextEx -> DrawTextCodepoint path for the default font:
+ minimum size 10, spacing = size / 10, glyph padding on both sides, advanceX falling back to the
+ atlas width, and 2px extra line spacing on '\n'. Spaces and tabs advance but produce no quad.*/
+void TextCache::Layout(Entry& entry) {
+    entry.glyphs.clear();
+    entry.width = 0;
+
+    Font font = GetFontDefault();
+    if (font.texture.id == 0 || font.glyphCount == 0) {
+        entry.width = MeasureText(entry.text.c_str(), entry.fontSize);
+        return;
+    }
+
+    const int defaultFontSize = 10;
+    int fontSize = (entry.fontSize < defaultFontSize) ? defaultFontSize : entry.fontSize;
+    float spacing = (float)(fontSize / defaultFontSize);
+    float scale = (float)fontSize / font.baseSize;
+    float pad = (float)font.glyphPadding;
+
+    float offsetX = 0.0f, offsetY = 0.0f, lineWidth = 0.0f, maxWidth = 0.0f;
+    const char* text = entry.text.c_str();
+    int length = (int)entry.text.size();
+    for (int i = 0; i < length;) {
+        int codepointSize = 0;
+        int codepoint = GetCodepointNext(&text[i], &codepointSize);
+        i += codepointSize;
+
+        if (codepoint == '\n') {
+            if (lineWidth > maxWidth) maxWidth = lineWidth;
+            offsetX = 0.0f; lineWidth = 0.0f;
+            offsetY += (float)fontSize + 2.0f;
+            continue;
+        }
+
+        int g = GetGlyphIndex(font, codepoint);
+        if (codepoint != ' ' && codepoint != '\t') {
+            GlyphQuad quad;
+            quad.source = { font.recs[g].x - pad, font.recs[g].y - pad, font.recs[g].width + 2.0f * pad, font.recs[g].height + 2.0f * pad };
+            quad.dest = { offsetX + font.glyphs[g].offsetX * scale - pad * scale, offsetY + font.glyphs[g].offsetY * scale - pad * scale,
+                          (font.recs[g].width + 2.0f * pad) * scale, (font.recs[g].height + 2.0f * pad) * scale };
+            entry.glyphs.push_back(quad);
+        }
+
+        float advance = (font.glyphs[g].advanceX == 0) ? font.recs[g].width * scale : font.glyphs[g].advanceX * scale;
+        lineWidth = offsetX + advance;
+        offsetX += advance + spacing;
+    }
+    if (lineWidth > maxWidth) maxWidth = lineWidth;
+    entry.width = (int)maxWidth;
+}
+
+TextCache::Entry* TextCache::Lookup(const char* text, int fontSize) {
+    unsigned long long key = HashText(text, fontSize);
+    auto found = index.find(key);
+    if (found != index.end()) {
+        Entry& entry = *found->second;
+        if (entry.fontSize == fontSize && entry.text == text) {
+            hits++;
+            entries.splice(entries.begin(), entries, found->second);
+            return &entries.front();
+        }
+        // Hash collision: drop the old entry and lay the new string out in its place.
+        entries.erase(found->second);
+        index.erase(found);
+    }
+
+    misses++;
+    if ((int)entries.size() >= capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+        evictions++;
+    }
+    entries.push_front(Entry{ key, text, fontSize, 0, {} });
+    Layout(entries.front());
+    index[key] = entries.begin();
+    return &entries.front();
+}
+
+int TextCache::Measure(const char* text, int fontSize) {
+    if (text == nullptr || text[0] == '\0') return 0;
+    return Lookup(text, fontSize)->width;
+}
+
+void TextCache::Draw(const char* text, int posX, int posY, int fontSize, Color color) {
+    if (text == nullptr || text[0] == '\0') return;
+    Entry* entry = Lookup(text, fontSize);
+    Font font = GetFontDefault();
+    if (font.texture.id == 0) {
+        Renderer::DrawText(text, posX, posY, fontSize, color);
+        return;
+    }
+    Renderer::DrawGlyphRun(text, font.texture, entry->glyphs.data(), (int)entry->glyphs.size(), posX, posY, fontSize, color);
+}
+
+static int AppendString(char* buffer, int pos, int size, const char* str) {
+    while (*str && pos < size - 1) buffer[pos++] = *str++;
+    return pos;
+}
+
+static int AppendInt(char* buffer, int pos, int size, int value) {
+    char digits[12];
+    int count = 0;
+    unsigned int v = (value < 0) ? (unsigned int)(-(long long)value) : (unsigned int)value;
+    do { digits[count++] = (char)('0' + v % 10); v /= 10; } while (v > 0);
+    if (value < 0 && pos < size - 1) buffer[pos++] = '-';
+    while (count > 0 && pos < size - 1) buffer[pos++] = digits[--count];
+    return pos;
+}
+
+const char* TextCache::Format(char* buffer, int size, const char* prefix, int value, const char* suffix) {
+    int pos = AppendString(buffer, 0, size, prefix);
+    pos = AppendInt(buffer, pos, size, value);
+    pos = AppendString(buffer, pos, size, suffix);
+    buffer[pos] = '\0';
+    return buffer;
+}
+
+const char* TextCache::Format(char* buffer, int size, const char* prefix, int a, const char* middle, int b, const char* suffix) {
+    int pos = AppendString(buffer, 0, size, prefix);
+    pos = AppendInt(buffer, pos, size, a);
+    pos = AppendString(buffer, pos, size, middle);
+    pos = AppendInt(buffer, pos, size, b);
+    pos = AppendString(buffer, pos, size, suffix);
+    buffer[pos] = '\0';
+    return buffer;
+}
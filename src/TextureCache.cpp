@@ -0,0 +1,159 @@
+﻿#include "TextureCache.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static long long NowMicros() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool TextureCache::Open(const char* directory, unsigned int buildFlags) {
+    if (!DirectoryExists(directory) && MakeDirectory(directory) != 0) {
+        TraceLog(LOG_WARNING, "TEXCACHE: cannot create %s, cache disabled", directory);
+        return false;
+    }
+    dir = directory;
+    flags = buildFlags;
+    PruneOldVersions();
+    return true;
+}
+
+// Before version 2 blobs were named after the source bytes, so every edit left an orphan; those go here.
+void TextureCache::PruneOldVersions() {
+    FilePathList files = LoadDirectoryFiles(dir.c_str());
+    int removed = 0;
+    for (unsigned int i = 0; i < files.count; i++) {
+        const char* path = files.paths[i];
+        bool stale = IsFileExtension(path, ".tmp");
+        if (!stale && IsFileExtension(path, ".tex")) {
+            unsigned int magicVersion[2] = { 0, 0 };
+            FILE* f = fopen(path, "rb");
+            if (f) {
+                stale = fread(magicVersion, sizeof(magicVersion), 1, f) != 1 ||
+                    magicVersion[0] != TEXCACHE_MAGIC || magicVersion[1] != TEXCACHE_VERSION;
+                fclose(f);
+            }
+        }
+        if (stale && remove(path) == 0) removed++;
+    }
+    UnloadDirectoryFiles(files);
+    if (removed > 0) TraceLog(LOG_INFO, "TEXCACHE: removed %d outdated files from %s", removed, dir.c_str());
+}
+
+// FNV-1a over 8-byte words (bytes for the tail): several times faster than per byte on multi-MB PNGs.
+unsigned long long TextureCache::HashBytes(const unsigned char* data, size_t size) {
+    unsigned long long h = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned long long word;
+        memcpy(&word, data + i, 8);
+        h = (h ^ word) * 1099511628211ULL;
+        h ^= h >> 29;
+    }
+    for (; i < size; i++) h = (h ^ data[i]) * 1099511628211ULL;
+    return h ^ (unsigned long long)size;
+}
+
+static int MipChainSize(int width, int height, int mipmaps, int format) {
+    int total = 0;
+    for (int i = 0; i < mipmaps; i++) {
+        total += GetPixelDataSize(width, height, format);
+        width = (width > 1) ? width / 2 : 1;
+        height = (height > 1) ? height / 2 : 1;
+    }
+    return total;
+}
+
+/* LOOKUP :
+ A hit costs one mmap and a header check; the pixels are read by the GPU upload straight from the
+ page cache. A miss decodes as before, applies the build options and writes the blob for next time.*/
+void TextureCache::Load(const char* assetPath, const unsigned char* source, int sourceSize, CachedImage& out) {
+    const char* ext = GetFileExtension(assetPath);
+    if (!IsOpen()) {
+        out.image = LoadImageFromMemory(ext, source, sourceSize);
+        return;
+    }
+
+    long long start = NowMicros();
+    unsigned long long hash = HashBytes(source, (size_t)sourceSize);
+    unsigned long long name = HashBytes((const unsigned char*)assetPath, strlen(assetPath));
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%016llx.tex", dir.c_str(), name);
+
+    unsigned long long decodeMicros = 0;
+    if (ReadBlob(path, hash, sourceSize, out, &decodeMicros)) {
+        hits++;
+        long long saved = (long long)decodeMicros - (NowMicros() - start);
+        if (saved > 0) savedMicros += saved;
+        return;
+    }
+    bool existed = FileExists(path);
+
+    out.image = LoadImageFromMemory(ext, source, sourceSize);
+    if (out.image.data == nullptr) return;
+    if (flags & TEXCACHE_PREMULTIPLY) ImageAlphaPremultiply(&out.image);
+    if (flags & TEXCACHE_MIPMAPS) ImageMipmaps(&out.image);
+
+    WriteBlob(path, out.image, hash, sourceSize, (unsigned long long)(NowMicros() - start));
+    misses++;
+    if (existed) rebuilt++;
+}
+
+bool TextureCache::ReadBlob(const char* path, unsigned long long hash, int sourceSize, CachedImage& out, unsigned long long* decodeMicros) {
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    if (!file->Open(path)) return false;
+    if (file->Size() < sizeof(TextureCacheHeader)) return false;
+
+    const TextureCacheHeader* h = (const TextureCacheHeader*)file->Data();
+    if (h->magic != TEXCACHE_MAGIC || h->version != TEXCACHE_VERSION || h->flags != flags) return false;
+    if (h->sourceHash != hash || h->sourceSize != (unsigned long long)sourceSize) return false;
+    if (h->width <= 0 || h->height <= 0 || h->mipmaps <= 0) return false;
+    if ((int)h->dataSize != MipChainSize(h->width, h->height, h->mipmaps, h->format)) return false;
+    if (file->Size() < sizeof(TextureCacheHeader) + h->dataSize) return false;
+
+    out.image.data = (void*)(file->Data() + sizeof(TextureCacheHeader));
+    out.image.width = h->width;
+    out.image.height = h->height;
+    out.image.mipmaps = h->mipmaps;
+    out.image.format = h->format;
+    *decodeMicros = h->decodeMicros;
+    out.mapping = std::move(file);
+    return true;
+}
+
+void TextureCache::WriteBlob(const char* path, const Image& image, unsigned long long hash, int sourceSize, unsigned long long decodeMicros) {
+    TextureCacheHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = TEXCACHE_MAGIC;
+    h.version = TEXCACHE_VERSION;
+    h.flags = flags;
+    h.width = image.width;
+    h.height = image.height;
+    h.mipmaps = image.mipmaps;
+    h.format = image.format;
+    h.dataSize = (unsigned int)MipChainSize(image.width, image.height, image.mipmaps, image.format);
+    h.sourceHash = hash;
+    h.sourceSize = (unsigned long long)sourceSize;
+    h.decodeMicros = decodeMicros;
+
+    // Written under a temporary name and renamed, so a crash mid-write never leaves a blob that looks valid.
+    // Two workers can build the same blob (a path queued twice), hence a unique temporary name per write.
+    static std::atomic<unsigned int> writeCounter{ 0 };
+    std::string tmp = std::string(path) + "." + std::to_string(writeCounter.fetch_add(1)) + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return;
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(image.data, 1, h.dataSize, f) == h.dataSize;
+    ok = (fclose(f) == 0) && ok;
+    if (ok) {
+        remove(path);
+        ok = (rename(tmp.c_str(), path) == 0);
+    }
+    if (!ok) remove(tmp.c_str());
+}
+
+void TextureCache::Release(CachedImage& img) {
+    if (img.mapping) img.mapping.reset();
+    else UnloadImage(img.image);
+    img.image = { 0 };
+}
@@ -0,0 +1,458 @@
+﻿#include "World.h"
+#include "Audio.h"
+#include <algorithm>
+#include <chrono>
+
+static double NowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+void World::Reset(LevelData* newLevel, unsigned long long seed) {
+    level = newLevel;
+    enemies.clear(); towers.clear(); projectiles.clear(); riders.clear();
+    supportTowers.clear();
+    enemySlots.clear(); freeEnemySlots.clear();
+    effects.Clear();
+    gold = level ? level->startGold : 0;
+    urukBlood = 0;
+    castleHealth = CASTLE_MAX_HEALTH;
+    waveSeed = seed;
+    currentWaveIndex = 0; enemiesSpawnedInWave = 0;
+    hasWave = PeekWave(0, currentWave);
+    castleInvulnerable = level && level->horde;
+    spawnTimer = 0.0f; waveDelayTimer = 0.0f; walkSoundTimer = 0.0f;
+    isBossActive = false; bossSpawned = false;
+    outcome = WorldOutcome::RUNNING;
+    for (int& n : enemiesByType) n = 0;
+    totalSpawned = 0; totalKilled = 0; totalLeaked = 0;
+    totalBlasts = 0; totalBlastHits = 0; totalRetired = 0;
+    totalShots = 0; totalShotHits = 0;
+    rng.Seed(seed);
+    grid.Build(enemies, 0.0f, 0.0f);
+}
+
+void World::Update(float dt) {
+    bossSpawned = false;
+    if (!level || outcome != WorldOutcome::RUNNING) return;
+    double start = NowMs();
+
+    UpdateWaves(dt);
+    UpdateWalkSounds(dt);
+    // Before the enemies move: they read their status, and burn and poison kills are collected below.
+    double effectsStart = NowMs();
+    effects.Tick(dt, enemies, [this](EnemyHandle h) { return Resolve(h); });
+    lastEffectsMs = NowMs() - effectsStart;
+    UpdateEnemies(dt);
+    if (outcome == WorldOutcome::RUNNING) {
+        // Everything below looks enemies up by position; the grid is valid until the next removal pass.
+        grid.Build(enemies, (float)level->mapWidth, (float)(MAP_ROWS * TILE_SIZE));
+        UpdateRiders(dt);
+        ApplyEnemyAuras();
+        for (Tower& t : towers) {
+            size_t fired = projectiles.size();
+            t.Update(dt, enemies, grid, projectiles, effects, leadTargeting);
+            for (size_t k = fired; k < projectiles.size(); k++) if (Projectile::GetSpeed(projectiles[k].type) > 0.0f) totalShots++;
+        }
+        UpdateProjectiles(dt);
+    }
+
+    lastUpdateMs = NowMs() - start;
+}
+
+/* WAVE SPAWNING :
+ Fast waves spawn several enemies in one tick; the leftover time carries over, so the spawn rate is the
+ same at any frame rate and a wave with an interval far below one frame (the horde) is not capped at
+ one enemy per frame.*/
+void World::UpdateWaves(float dt) {
+    if (hasWave) {
+        const EnemyWave& w = currentWave;
+        if (enemiesSpawnedInWave < w.enemyCount) {
+            spawnTimer += dt;
+            while (spawnTimer >= w.spawnInterval && enemiesSpawnedInWave < w.enemyCount && !level->paths.empty()) {
+                spawnTimer -= w.spawnInterval;
+                SpawnEnemy(w);
+            }
+        }
+        else if (enemies.empty()) {
+            waveDelayTimer += dt;
+            if (waveDelayTimer > 3.0f) {
+                currentWaveIndex++; enemiesSpawnedInWave = 0; waveDelayTimer = 0.0f; spawnTimer = 0.0f;
+                hasWave = PeekWave(currentWaveIndex, currentWave);
+            }
+        }
+    }
+    else if (enemies.empty()) {
+        outcome = WorldOutcome::VICTORY;
+    }
+}
+
+void World::SpawnEnemy(const EnemyWave& w) {
+    int pathIndex = rng.Range(0, (int)level->paths.size() - 1);
+    std::vector<Vector2>* chosenPath = level->paths[pathIndex];
+
+    int dynamicHealth = w.healthBonus + (level->levelID * 15);
+    enemies.push_back(Enemy(w.enemyType, chosenPath, enemyTextures[(int)w.enemyType], w.speedMultiplier, dynamicHealth));
+    AddEnemyHandle(enemies.back(), (int)enemies.size() - 1);
+    enemiesByType[(int)w.enemyType]++;
+    totalSpawned++;
+
+    if (w.enemyType == EnemyType::NAZGUL) {
+        isBossActive = true;
+        bossSpawned = true;
+    }
+
+    // SPAWN_1..3 are consecutive ids, so the random variant is an offset, not a formatted name.
+    int rndSpawn = GetRandomValue(0, 2);
+    Audio::PlaySFXAt((SoundId)((int)SoundId::SPAWN_1 + rndSpawn), (*chosenPath)[0], 0.1f + GetRandomValue(-1, 1) / 10.0f);
+    enemiesSpawnedInWave++;
+}
+
+void World::UpdateWalkSounds(float dt) {
+    if (enemies.empty()) return;
+    walkSoundTimer += dt;
+    if (walkSoundTimer <= 0.6f) return;
+    walkSoundTimer = 0.0f;
+    bool hasInfantry = enemiesByType[(int)EnemyType::ORC] + enemiesByType[(int)EnemyType::URUK] > 0;
+    bool hasHeavy = enemiesByType[(int)EnemyType::TROLL] + enemiesByType[(int)EnemyType::GROND] + enemiesByType[(int)EnemyType::COMMANDER] > 0;
+    bool hasNazgul = enemiesByType[(int)EnemyType::NAZGUL] > 0;
+    if (hasInfantry) Audio::PlaySFX(SoundId::ORC_WALK, 0.3f, 1.0f);
+    if (hasHeavy) Audio::PlaySFX(SoundId::HEAVY_WALK, 0.2f, 0.8f);
+    if (hasNazgul) Audio::PlaySFX(SoundId::HEAVY_WALK, 0.7f, 0.1f);
+}
+
+// Swap-with-last: O(1) instead of shifting every enemy behind it, which dominated removal in the horde.
+// The slot of the enemy moved into 'index' follows it, so handles to it stay valid.
+void World::RemoveEnemy(size_t index) {
+    // The boss theme and the boss prefetch in main.cpp follow this flag, so it drops with the last Nazgul.
+    if (--enemiesByType[(int)enemies[index].GetType()] == 0 && enemies[index].GetType() == EnemyType::NAZGUL) isBossActive = false;
+    EnemySlot& slot = enemySlots[enemies[index].GetHandle().slot];
+    slot.index = -1;
+    slot.generation++;
+    freeEnemySlots.push_back(enemies[index].GetHandle().slot);
+    if (index + 1 != enemies.size()) {
+        enemies[index] = std::move(enemies.back());
+        enemySlots[enemies[index].GetHandle().slot].index = (int)index;
+    }
+    enemies.pop_back();
+}
+
+void World::AddEnemyHandle(Enemy& enemy, int index) {
+    EnemyHandle h;
+    if (!freeEnemySlots.empty()) {
+        h.slot = freeEnemySlots.back();
+        freeEnemySlots.pop_back();
+    }
+    else {
+        h.slot = (int)enemySlots.size();
+        enemySlots.push_back({ -1, 1 });
+    }
+    enemySlots[h.slot].index = index;
+    h.generation = enemySlots[h.slot].generation;
+    enemy.SetHandle(h);
+}
+
+int World::PathIndexOf(const std::vector<Vector2>* path) const {
+    for (int i = 0; i < (int)level->paths.size(); i++) if (level->paths[i] == path) return i;
+    return -1;
+}
+
+void World::AddBlood(int amount) {
+    urukBlood += amount;
+    if (urukBlood > MAX_BLOOD) urukBlood = MAX_BLOOD;
+}
+
+void World::UpdateEnemies(float dt) {
+    // The enemy swapped into slot i by a removal has not been updated yet, so i only advances on survivors.
+    for (size_t i = 0; i < enemies.size();) {
+        Enemy& e = enemies[i];
+        e.Update(dt);
+        if (!e.IsAlive()) {
+            gold += 15;
+            AddBlood((int)(e.GetManaReward() * 0.4f));
+            Audio::PlaySFXAt(SoundId::ORC_DEATH, e.GetPosition(), 0.1f, GetRandomValue(80, 120) / 100.0f);
+            Audio::PlaySFX(SoundId::GOLD_GAIN, 0.1f, 1.0f + GetRandomValue(0, 2) / 10.0f);
+            totalKilled++;
+            RemoveEnemy(i);
+            continue;
+        }
+        if (e.ReachedEnd()) {
+            if (!castleInvulnerable) castleHealth -= e.GetDamage();
+            totalLeaked++;
+            RemoveEnemy(i);
+            if (castleHealth <= 0) {
+                castleHealth = 0;
+                outcome = WorldOutcome::DEFEAT;
+                return;
+            }
+            continue;
+        }
+        i++;
+    }
+}
+
+void World::UpdateRiders(float dt) {
+    for (int i = 0; i < (int)riders.size(); i++) {
+        Rohirrim& rider = riders[i];
+        rider.Update(dt);
+        if (rider.active && particles) particles->Emit(EmitterType::ROHIRRIM_DUST, rider.position, 20.0f * dt);
+
+        // Riders trample everything within 30 px of a 20 px body; the grid query is widened to cover that.
+        grid.ForEachInRange(rider.position, 35.0f, [&](int index) {
+            Enemy& e = enemies[index];
+            if (!e.IsAlive() || !CheckCollisionCircles(rider.position, 30, e.GetPosition(), 20)) return true;
+            float damageRate = 0.0f;
+            if (e.GetType() == EnemyType::NAZGUL || e.GetType() == EnemyType::TROLL) damageRate = 0.008f;
+            else damageRate = 0.02f;
+            int damage = (int)(e.GetHealth() * damageRate);
+            if (damage < 1) damage = 1;
+            e.TakeDamage(damage);
+            if (particles && GetRandomValue(0, 4) == 0) particles->Emit(EmitterType::BLOOD, e.GetPosition());
+            if (!e.IsAlive()) {
+                if (e.GetType() == EnemyType::NAZGUL || e.GetType() == EnemyType::TROLL) { gold += 50; AddBlood(20); }
+                else { gold += 3; AddBlood((int)(e.GetManaReward() * 0.12f)); }
+            }
+            return true;
+        });
+        if (!rider.active) { riders.erase(riders.begin() + i); i--; }
+    }
+}
+
+void World::UpdateProjectiles(float dt) {
+    for (size_t i = 0; i < projectiles.size();) {
+        Projectile& p = projectiles[i];
+        /* HOMING :
+         A homing projectile whose target has died or been removed is dropped on the spot instead of
+         flying on until it leaves the map. While the target lives, only the target is tested for a hit,
+         so the grid is not queried for it at all.*/
+        int target = -1;
+        if (p.active && p.IsHoming()) {
+            target = Resolve(p.GetTarget());
+            if (target < 0 || !enemies[target].IsAlive() || p.GetAge() > HOMING_MAX_AGE) {
+                p.active = false;
+                totalRetired++;
+            }
+            else p.Steer(enemies[target].GetPosition(), dt);
+        }
+        if (p.active) p.Update(dt);
+        if (p.active && target >= 0) {
+            Enemy& e = enemies[target];
+            if (CheckCollisionCircles(p.position, 5.0f, e.GetPosition(), e.GetRadius())) HitEnemy(p, target);
+        }
+        else if (p.active && p.HasLanded()) {
+            if (Blast(p.position, p.GetSplashRadius(), p.damage, p.type, -1) > 0) totalShotHits++;
+            if (particles) particles->Emit(EmitterType::ROHIRRIM_DUST, p.position);
+            Audio::PlaySFXAt(SoundId::SWORD_HIT, p.position, 0.5f, 0.6f);
+            p.active = false;
+        }
+        else if (p.active && (p.type == ProjectileType::ARROW || p.type == ProjectileType::ICE)) {
+            // First living enemy the arrow touches takes the hit; ice shatters over the ones around it.
+            grid.ForEachInRange(p.position, 5.0f, [&](int index) {
+                if (!enemies[index].IsAlive()) return true;
+                HitEnemy(p, index);
+                return false;
+            });
+        }
+        if (!p.active) {
+            if (i + 1 != projectiles.size()) projectiles[i] = std::move(projectiles.back());
+            projectiles.pop_back();
+            continue;
+        }
+        i++;
+    }
+}
+
+void World::HitEnemy(Projectile& p, int index) {
+    Enemy& e = enemies[index];
+    e.TakeDamage(p.damage);
+    totalShotHits++;
+    if (particles) {
+        particles->Emit(EmitterType::BLOOD, e.GetPosition());
+        if (p.type == ProjectileType::ICE) particles->Emit(EmitterType::ICE_SHATTER, e.GetPosition());
+    }
+    if (p.type == ProjectileType::ICE) Audio::PlaySFXAt(SoundId::ICE_HIT, e.GetPosition(), 0.3f, 1.0f);
+    else Audio::PlaySFXAt(SoundId::ARROW_HIT, e.GetPosition(), 0.1f + GetRandomValue(0, 2) / 10.0f);
+    if (p.type == ProjectileType::ICE) effects.Apply(e, EffectKind::SLOW, 2.0f, 0.5f);
+    else if (p.type == ProjectileType::ARROW) effects.Apply(e, EffectKind::POISON, 4.0f, 2.0f);
+    p.active = false;
+    if (!e.IsAlive()) { gold += 15; AddBlood(e.GetManaReward()); }
+    if (p.GetSplashRadius() > 0.0f) Blast(e.GetPosition(), p.GetSplashRadius(), p.damage / 2, p.type, index);
+}
+
+/* SPLASH DAMAGE :
+ One radius query on the enemy grid per blast, so the cost follows the number of enemies actually
+ caught, not the size of the horde. Effects are per blast, not per enemy hit: a boulder landing in a
+ crowd of two hundred still emits one dust cloud.*/
+int World::Blast(Vector2 center, float radius, int damage, ProjectileType type, int skip) {
+    totalBlasts++;
+    int hits = 0;
+    grid.ForEachInRange(center, radius, [&](int index) {
+        Enemy& e = enemies[index];
+        if (index == skip || !e.IsAlive()) return true;
+        e.TakeDamage(damage);
+        if (type == ProjectileType::ICE) effects.Apply(e, EffectKind::SLOW, 2.0f, 0.5f);
+        else if (type == ProjectileType::BOULDER) effects.Apply(e, EffectKind::BURN, 3.0f, 5.0f);
+        hits++;
+        if (!e.IsAlive()) { gold += 15; AddBlood(e.GetManaReward()); }
+        return true;
+    });
+    totalBlastHits += hits;
+    return hits;
+}
+
+size_t World::GetMemoryBytes() const {
+    return enemies.capacity() * sizeof(Enemy) + towers.capacity() * sizeof(Tower) + projectiles.capacity() * sizeof(Projectile) +
+        riders.capacity() * sizeof(Rohirrim) + grid.GetMemoryBytes() + enemySlots.capacity() * sizeof(EnemySlot) +
+        freeEnemySlots.capacity() * sizeof(int) + effects.GetMemoryBytes();
+}
+
+bool World::BuildTower(Vector2 position, TowerType type) {
+    int cost = Tower::GetBuildCost(type);
+    if (gold < cost) return false;
+    gold -= cost;
+    towers.emplace_back(position, towerTextures[(int)type], projectileTextures[(int)type], type);
+    Tower& tower = towers.back();
+    tower.AddSpent(cost);
+    if (tower.IsSupport()) {
+        supportTowers.push_back((int)towers.size() - 1);
+        RefreshAround(position, tower.GetAura().radius);
+    }
+    else RefreshBuff(tower);
+    return true;
+}
+
+bool World::UpgradeTower(int index) {
+    Tower& tower = towers[index];
+    int cost = tower.GetUpgradeCost();
+    if (!tower.CanUpgrade() || gold < cost) return false;
+    gold -= cost;
+    tower.AddSpent(cost);
+    tower.Upgrade();
+    // A banner's aura grew stronger and wider; any other tower kept its buff and just rescaled its stats.
+    if (tower.IsSupport()) RefreshAround(tower.GetPosition(), tower.GetAura().radius);
+    return true;
+}
+
+int World::SellTower(int index) {
+    const Tower& tower = towers[index];
+    int refund = tower.GetSpent() / 2;
+    bool support = tower.IsSupport();
+    Vector2 position = tower.GetPosition();
+    float radius = tower.GetAura().radius;
+    gold += refund;
+    // Erased, not swap-popped: the draw order of towers on the same row stays as the player built them.
+    towers.erase(towers.begin() + index);
+    if (support) {
+        RebuildSupportList();
+        RefreshAround(position, radius);
+    }
+    else {
+        for (int& s : supportTowers) if (s > index) s--;
+    }
+    return refund;
+}
+
+/* BANNER AURAS :
+ A tower gets, for each bonus separately, the best one among the banners whose radius covers it, so two
+ banners side by side are no better than the stronger of them. Banners do not buff each other.*/
+void World::RefreshBuff(Tower& tower) {
+    TowerBuff buff;
+    if (!tower.IsSupport()) {
+        for (int s : supportTowers) {
+            TowerAura aura = towers[s].GetAura();
+            if (!CheckCollisionPointCircle(tower.GetPosition(), towers[s].GetPosition(), aura.radius)) continue;
+            buff.rate = std::max(buff.rate, aura.rateBonus);
+            buff.range = std::max(buff.range, aura.rangeBonus);
+            buff.damage = std::max(buff.damage, aura.damageBonus);
+        }
+    }
+    tower.SetBuff(buff);
+}
+
+void World::RefreshAround(Vector2 center, float radius) {
+    for (Tower& t : towers) {
+        if (CheckCollisionPointCircle(t.GetPosition(), center, radius)) RefreshBuff(t);
+    }
+}
+
+/* ENEMY AURAS :
+ Unlike the tower buffs, the banners' slow has to follow the enemies, so it is reapplied every tick to
+ the enemies the grid finds inside each banner's radius. The effect is short and refreshes (see
+ StatusEffects.h): it wears off a moment after an enemy walks out, and where an ice bolt's slow is
+ stronger, the stronger one wins.*/
+const float AURA_SLOW_SECONDS = 0.25f;
+
+void World::ApplyEnemyAuras() {
+    for (int s : supportTowers) {
+        TowerAura aura = towers[s].GetAura();
+        grid.ForEachInRange(towers[s].GetPosition(), aura.radius, [&](int index) {
+            if (enemies[index].IsAlive()) effects.Apply(enemies[index], EffectKind::SLOW, AURA_SLOW_SECONDS, aura.enemySlow);
+            return true;
+        });
+    }
+}
+
+void World::RebuildSupportList() {
+    supportTowers.clear();
+    for (int i = 0; i < (int)towers.size(); i++) if (towers[i].IsSupport()) supportTowers.push_back(i);
+}
+
+bool World::CastGandalf() {
+    if (urukBlood < COST_GANDALF) return false;
+    urukBlood -= COST_GANDALF;
+    for (Enemy& e : enemies) {
+        // Frozen in place. With the FEAR rule enabled (off by default, see DEFAULT_EFFECT_RULES) they then
+        // flee at half speed once the stun wears off.
+        effects.Apply(e, EffectKind::STUN, 3.0f, 1.0f);
+        effects.Apply(e, EffectKind::FEAR, 6.0f, 0.5f);
+        if (particles) particles->Emit(EmitterType::GANDALF_SPARK, e.GetPosition());
+    }
+    return true;
+}
+
+bool World::CallRohirrim() {
+    if (urukBlood < COST_ROHIRRIM || !level || !riderFrames) return false;
+    urukBlood -= COST_ROHIRRIM;
+    for (auto* path : level->paths) riders.emplace_back(path, riderFrames);
+    return true;
+}
+
+/* DEPTH-SORTED WORLD PASS :
+ Towers, enemies and riders share one list ordered by the y of their feet, so whoever stands lower on
+ the screen is drawn in front. Projectiles and the flying Nazgul are put on the AIR layer above the
+ ground units. Entities outside the view (plus a margin for sprites and health bars) are not added,
+ so a horde spread over the whole map only costs what is on screen. Particles on the DECALS layer
+ (blood, dust) are drawn first, under every unit; AIR particles last, over them.*/
+void World::Draw(WorldRenderList& list, Rectangle view) const {
+    const float margin = 160.0f;
+    float left = view.x - margin, right = view.x + view.width + margin;
+    float top = view.y - margin, bottom = view.y + view.height + margin;
+    auto visible = [&](Vector2 p) { return p.x >= left && p.x <= right && p.y >= top && p.y <= bottom; };
+
+    list.Clear();
+    for (int i = 0; i < (int)towers.size(); i++) {
+        if (visible(towers[i].GetPosition())) list.Add(RenderLayer::GROUND, towers[i].GetPosition().y + 14.0f, RenderKind::TOWER, i);
+    }
+    for (int i = 0; i < (int)enemies.size(); i++) {
+        if (!visible(enemies[i].GetPosition())) continue;
+        RenderLayer layer = (enemies[i].GetType() == EnemyType::NAZGUL) ? RenderLayer::AIR : RenderLayer::GROUND;
+        list.Add(layer, enemies[i].GetPosition().y + enemies[i].GetDrawSize() / 2.0f, RenderKind::ENEMY, i);
+    }
+    for (int i = 0; i < (int)riders.size(); i++) {
+        if (visible(riders[i].position)) list.Add(RenderLayer::GROUND, riders[i].position.y + 40.0f, RenderKind::RIDER, i);
+    }
+    for (int i = 0; i < (int)projectiles.size(); i++) {
+        if (visible(projectiles[i].position)) list.Add(RenderLayer::AIR, projectiles[i].position.y, RenderKind::PROJECTILE, i);
+    }
+    list.Sort();
+
+    if (particles) particles->Draw(RenderLayer::DECALS);
+    for (int i = 0; i < list.Count(); i++) {
+        const RenderItem& item = list[i];
+        if (item.kind == RenderKind::TOWER) towers[item.index].Draw();
+        else if (item.kind == RenderKind::ENEMY) enemies[item.index].Draw();
+        else if (item.kind == RenderKind::RIDER) riders[item.index].Draw();
+        else projectiles[item.index].Draw();
+    }
+    if (particles) particles->Draw(RenderLayer::AIR);
+}
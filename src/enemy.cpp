@@ -1,9 +1,10 @@
 ﻿#include "Enemy.h"
+#include "Renderer.h"
 
-Enemy::Enemy(EnemyType type, std::vector<Vector2>* path, Texture2D tex, float speedMult, int hpBonus)
+Enemy::Enemy(EnemyType type, std::vector<Vector2>* path, TextureHandle tex, float speedMult, int hpBonus)
     : position({ 0,0 }), path(path), currentPoint(0), texture(tex), type(type),
     alive(true), health(0), maxHealth(0), speed(0.0f), distanceTraveled(0.0f),
-    manaReward(0), stunTimer(0.0f), slowTimer(0.0f), slowFactor(1.0f), frozen(false),
+    manaReward(0),
     currentFrame(0), animTimer(0.0f), facing(0)
 {
     
@@ -48,29 +49,53 @@ Enemy::Enemy(EnemyType type, std::vector<Vector2>* path, Texture2D tex, float sp
     speed *= speedMult;        
 
    
-    frameWidth = texture.width / 3;
-    frameHeight = texture.height / 4;
+    const Texture2D& sprite = texture.Get();
+    frameWidth = sprite.width / 3;
+    frameHeight = sprite.height / 4;
+}
+
+Enemy::Enemy(const EnemyState& s, std::vector<Vector2>* path, TextureHandle tex)
+    : position(s.position), path(path), currentPoint(s.currentPoint), texture(tex), type((EnemyType)s.type),
+    alive(s.alive != 0), health(s.health), maxHealth(s.maxHealth), speed(s.speed), distanceTraveled(s.distanceTraveled),
+    manaReward(s.manaReward),
+    damage(s.damage), currentFrame(s.currentFrame), animTimer(s.animTimer), facing(s.facing)
+{
+    handle.slot = s.handleSlot;
+    handle.generation = s.handleGeneration;
+    const Texture2D& sprite = texture.Get();
+    frameWidth = sprite.width / 3;
+    frameHeight = sprite.height / 4;
+}
+
+EnemyState Enemy::GetState() const {
+    EnemyState s;
+    s.type = (int)type; s.pathIndex = -1; s.currentPoint = currentPoint; s.position = position;
+    s.alive = alive ? 1 : 0; s.health = health; s.maxHealth = maxHealth; s.speed = speed; s.distanceTraveled = distanceTraveled;
+    s.manaReward = manaReward;
+    s.damage = damage; s.currentFrame = currentFrame; s.animTimer = animTimer; s.facing = facing;
+    s.handleSlot = handle.slot; s.handleGeneration = handle.generation;
+    return s;
 }
 
 void Enemy::Update(float dt) {
     if (!alive) return;
 
     /* STATUS EFFECT LOGIC :
-     Prioritizes Stun over Slow.
+     Prioritizes Stun over everything else.
      If Stunned: Speed is set to 0.
      If Slowed (and not stunned): Speed is multiplied by a factor (e.g., 0.5 for 50% slow).
-     The timers are decremented by 'dt' (delta time) every frame.*/
+     If Afraid (and not stunned): the enemy walks back the way it came, slowed as well.
+     The timers are counted down by StatusEffects, not here.*/
     float actualSpeed = speed;
-    if (stunTimer > 0.0f) {
-        stunTimer -= dt;
+    bool fleeing = false;
+    if (status.stun > 0.0f) {
         actualSpeed = 0.0f;
-        frozen = true;
     }
     else {
-        frozen = false;
-        if (slowTimer > 0.0f) {
-            slowTimer -= dt;
-            actualSpeed *= slowFactor;
+        if (status.slow > 0.0f) actualSpeed *= status.slowFactor;
+        if (status.fear > 0.0f) {
+            actualSpeed *= status.fearSpeed;
+            fleeing = true;
         }
     }
 
@@ -79,7 +104,29 @@ void Enemy::Update(float dt) {
      If the enemy is close enough to the target (dist <= moveStep), it snaps to the target
      and increments the 'currentPoint' index to target the next node in the path vector.
      Otherwise, it moves along the normalized direction vector.*/
-    if (path && currentPoint < path->size()) {
+    if (path && fleeing) {
+        // Back towards the previous waypoint; the spawn point is as far as anyone flees.
+        if (currentPoint > 0) {
+            Vector2 target = (*path)[currentPoint - 1];
+            Vector2 dir = Vector2Subtract(target, position);
+            float dist = Vector2Length(dir);
+            if (fabs(dir.x) > fabs(dir.y)) facing = (dir.x > 0) ? 2 : 1;
+            else facing = (dir.y > 0) ? 0 : 3;
+            float moveStep = actualSpeed * dt;
+            if (dist <= moveStep) {
+                position = target;
+                currentPoint--;
+                distanceTraveled -= dist;
+            }
+            else {
+                position = Vector2Add(position, Vector2Scale(Vector2Normalize(dir), moveStep));
+                distanceTraveled -= moveStep;
+            }
+        }
+        animTimer += dt;
+        if (animTimer >= 0.2f) { animTimer = 0.0f; currentFrame = (currentFrame + 1) % 3; }
+    }
+    else if (path && currentPoint < path->size()) {
         Vector2 target = (*path)[currentPoint];
         Vector2 dir = Vector2Subtract(target, position);
         float dist = Vector2Length(dir);
@@ -122,17 +169,12 @@ void Enemy::Update(float dt) {
 void Enemy::Draw() const {
     if (!alive) return;
 
-    float drawSize = 48.0f;
-    if (type == EnemyType::TROLL) drawSize = 64.0f;
-    else if (type == EnemyType::GROND) drawSize = 100.0f;
-    else if (type == EnemyType::NAZGUL) drawSize = 130.0f; 
-    else if (type == EnemyType::COMMANDER) {
-        drawSize = 60.0f; 
-    }
+    float drawSize = GetDrawSize();
+    const Texture2D& sprite = texture.Get();
 
     Rectangle source;
-    if (texture.width == texture.height) { // Tek kare resimse
-        source = { 0, 0, (float)texture.width, (float)texture.height };
+    if (sprite.width == sprite.height) { // Tek kare resimse
+        source = { 0, 0, (float)sprite.width, (float)sprite.height };
     }
     else { 
         source = { (float)currentFrame * frameWidth, (float)facing * frameHeight, (float)frameWidth, (float)frameHeight };
@@ -142,10 +184,13 @@ void Enemy::Draw() const {
     Vector2 origin = { drawSize / 2.0f, drawSize / 2.0f };
 
     Color tint = WHITE;
-    if (stunTimer > 0.0f) tint = GOLD;
-    else if (slowTimer > 0.0f) tint = SKYBLUE;
+    if (status.stun > 0.0f) tint = GOLD;
+    else if (status.fear > 0.0f) tint = VIOLET;
+    else if (status.slow > 0.0f) tint = SKYBLUE;
+    else if (status.burning) tint = ORANGE;
+    else if (status.poisoned) tint = LIME;
 
-    DrawTexturePro(texture, source, dest, origin, 0.0f, tint);
+    Renderer::DrawTexturePro(sprite, source, dest, origin, 0.0f, tint);
 
    
 
@@ -159,17 +204,35 @@ void Enemy::Draw() const {
      based on the current health percentage.*/
     float pct = (float)health / (float)maxHealth;
     int barWidth = (int)drawSize;
-    DrawRectangle((int)position.x - barWidth / 2, (int)position.y - (int)(drawSize / 2) - 10, barWidth, 6, RED);
-    DrawRectangle((int)position.x - barWidth / 2, (int)position.y - (int)(drawSize / 2) - 10, (int)(barWidth * pct), 6, GREEN);
+    Renderer::DrawRectangle((int)position.x - barWidth / 2, (int)position.y - (int)(drawSize / 2) - 10, barWidth, 6, RED);
+    Renderer::DrawRectangle((int)position.x - barWidth / 2, (int)position.y - (int)(drawSize / 2) - 10, (int)(barWidth * pct), 6, GREEN);
+}
+
+Vector2 Enemy::PredictPosition(float seconds) const {
+    if (!alive || !path || seconds <= 0.0f) return position;
+    // No movement while stunned; a slow that outlasts the stun covers the start of the walk. Time spent
+    // fleeing is counted as standing still, which is close enough for aiming and never overshoots.
+    float t = seconds;
+    float still = fminf(t, fmaxf(status.stun, status.fear));
+    float slowed = fmaxf(0.0f, fminf(t, status.slow) - still);
+    float distance = speed * (slowed * status.slowFactor + (t - still - slowed));
+
+    Vector2 from = position;
+    for (size_t i = currentPoint; i < path->size(); i++) {
+        Vector2 to = (*path)[i];
+        float leg = Vector2Distance(from, to);
+        if (distance <= leg) return (leg > 0.0f) ? Vector2Lerp(from, to, distance / leg) : to;
+        distance -= leg;
+        from = to;
+    }
+    return from;
 }
 
 void Enemy::TakeDamage(int dmg) {
+    if (status.damageTakenScale != 1.0f) dmg = (int)(dmg * status.damageTakenScale + 0.5f);
     health -= dmg;
     if (health <= 0) {
         health = 0;
         alive = false;
     }
 }
-
-void Enemy::ApplyStun(float duration) { stunTimer = duration; }
-void Enemy::ApplySlow(float factor, float duration) { slowFactor = factor; slowTimer = duration; }
@@ -4,9 +4,23 @@
 #include "Tower.h"      
 #include "Projectile.h"  
 #include "Audio.h" 
+#include "Renderer.h"
+#include "DepthSort.h"
+#include "Hud.h"
+#include "TextCache.h"
+#include "Particles.h"
+#include "AssetLoader.h"
+#include "AssetRegistry.h"
+#include "Level.h"
+#include "LevelResources.h"
+#include "World.h"
+#include "Benchmark.h"
+#include "Snapshot.h"
+#include "SnapshotHistory.h"
 #include <vector>
 #include <string>
 #include <algorithm> 
+#include <ctime>
 
 
 #define MIN(a, b) ((a)<(b)?(a):(b))
@@ -15,92 +29,6 @@
 enum class GameScreen { TITLE, LEVEL_SELECT, LEVEL_INTRO, GAMEPLAY, VICTORY, GAMEOVER };
 
 
-const int TILE_SIZE = 64;
-const int MAP_ROWS = 12;
-
-
-struct EnemyWave {
-    int enemyCount;
-    EnemyType enemyType;
-    float spawnInterval;
-    float speedMultiplier;
-    int healthBonus;
-};
-
-
-struct LevelData {
-    int levelID;
-    const char* name;
-    Texture2D background;
-    Color bgColor;
-
-    std::vector<std::vector<int>> tileMap;
-    std::vector<std::vector<Vector2>*> paths;
-    int startGold;
-    int mapWidth;
-    int cols;
-
-    Vector2 castlePos;
-    float castleScale;
-    std::vector<EnemyWave> waves;
-
-    std::vector<std::string> storyLines;
-};
-
-// Recursive Depth-First Search (DFS) algorithm to find all valid paths from start to finish.
-// It marks tiles as visited (-1) to prevent loops, explores all 4 cardinal directions,
-// and backtracks (resets tile value) to allow finding alternative routes.
-void FindAllPathsRecursive(int x, int y, int cols, int rows,
-    std::vector<std::vector<int>>& tileMap,
-    std::vector<Vector2> currentPath,
-    std::vector<std::vector<Vector2>*>& outPaths)
-{
-    currentPath.push_back({ (float)x * TILE_SIZE + TILE_SIZE / 2, (float)y * TILE_SIZE + TILE_SIZE / 2 });
-
-    if (tileMap[y][x] == 3) {
-        outPaths.push_back(new std::vector<Vector2>(currentPath));
-        return;
-    }
-
-    int originalValue = tileMap[y][x];
-    tileMap[y][x] = -1;
-
-    int dx[] = { 1, 0, -1, 0 };
-    int dy[] = { 0, 1, 0, -1 };
-
-    for (int i = 0; i < 4; i++) {
-        int nx = x + dx[i];
-        int ny = y + dy[i];
-
-        if (nx >= 0 && nx < cols && ny >= 0 && ny < rows) {
-            if (tileMap[ny][nx] == 1 || tileMap[ny][nx] == 3) {
-                FindAllPathsRecursive(nx, ny, cols, rows, tileMap, currentPath, outPaths);
-            }
-        }
-    }
-    tileMap[y][x] = originalValue;
-}
-
-
-std::vector<std::vector<Vector2>*> GeneratePathsFromMap(const std::vector<std::vector<int>>& map) {
-    std::vector<std::vector<Vector2>*> allPaths;
-    if (map.empty()) return allPaths;
-
-    int rows = map.size();
-    int cols = map[0].size();
-    std::vector<std::vector<int>> tempMap = map;
-
-    for (int y = 0; y < rows; y++) {
-        for (int x = 0; x < cols; x++) {
-            if (tempMap[y][x] == 2) {
-                std::vector<Vector2> initialPath;
-                FindAllPathsRecursive(x, y, cols, rows, tempMap, initialPath, allPaths);
-            }
-        }
-    }
-    return allPaths;
-}
-
 /* Immediate Mode GUI implementation : Handles collision detection, visual state changes
  (hover/click), and audio feedback in a single pass. Returns true only on mouse release.*/
 bool GuiButton(Rectangle rect, const char* text, Texture2D texNormal, Texture2D texHover, Vector2 mousePos) {
@@ -108,108 +36,48 @@ bool GuiButton(Rectangle rect, const char* text, Texture2D texNormal, Texture2D
     bool clicked = false;
     if (hover) {
         if (IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
-            if (texHover.id > 0) DrawTexturePro(texHover, { 0,0,(float)texHover.width,(float)texHover.height }, { rect.x + 2, rect.y + 2, rect.width - 4, rect.height - 4 }, { 0,0 }, 0, WHITE);
-            else { DrawRectangleRec(rect, Color{ 80, 80, 80, 255 }); DrawRectangleLinesEx(rect, 4, DARKBROWN); }
+            if (texHover.id > 0) Renderer::DrawTexturePro(texHover, { 0,0,(float)texHover.width,(float)texHover.height }, { rect.x + 2, rect.y + 2, rect.width - 4, rect.height - 4 }, { 0,0 }, 0, WHITE);
+            else { Renderer::DrawRectangleRec(rect, Color{ 80, 80, 80, 255 }); Renderer::DrawRectangleLinesEx(rect, 4, DARKBROWN); }
         }
         else {
-            if (texHover.id > 0) DrawTexturePro(texHover, { 0,0,(float)texHover.width,(float)texHover.height }, rect, { 0,0 }, 0, WHITE);
-            else { DrawRectangleRec(rect, Color{ 169, 169, 169, 255 }); DrawRectangleLinesEx(rect, 4, GOLD); }
+            if (texHover.id > 0) Renderer::DrawTexturePro(texHover, { 0,0,(float)texHover.width,(float)texHover.height }, rect, { 0,0 }, 0, WHITE);
+            else { Renderer::DrawRectangleRec(rect, Color{ 169, 169, 169, 255 }); Renderer::DrawRectangleLinesEx(rect, 4, GOLD); }
 
             if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
                 clicked = true;
-                Audio::PlaySFX("ui_click");
+                Audio::PlaySFX(SoundId::UI_CLICK);
             }
         }
     }
     else {
-        if (texNormal.id > 0) DrawTexturePro(texNormal, { 0,0,(float)texNormal.width,(float)texNormal.height }, rect, { 0,0 }, 0, WHITE);
-        else { DrawRectangleRec(rect, DARKGRAY); DrawRectangleLinesEx(rect, 4, BLACK); }
+        if (texNormal.id > 0) Renderer::DrawTexturePro(texNormal, { 0,0,(float)texNormal.width,(float)texNormal.height }, rect, { 0,0 }, 0, WHITE);
+        else { Renderer::DrawRectangleRec(rect, DARKGRAY); Renderer::DrawRectangleLinesEx(rect, 4, BLACK); }
     }
-    int fontSize = 20; int textWidth = MeasureText(text, fontSize);
+    int fontSize = 20; int textWidth = TextCache::Measure(text, fontSize);
     int textX = (int)(rect.x + (rect.width - textWidth) / 2); int textY = (int)(rect.y + (rect.height - fontSize) / 2);
-    DrawText(text, textX + 2, textY + 2, fontSize, BLACK);
-    DrawText(text, textX, textY, fontSize, hover ? DARKBLUE : RAYWHITE);
+    TextCache::Draw(text, textX + 2, textY + 2, fontSize, BLACK);
+    TextCache::Draw(text, textX, textY, fontSize, hover ? DARKBLUE : RAYWHITE);
     return clicked;
 }
 
-float GetTowerRange(TowerType type) {
-    if (type == TowerType::ARCHER) return 250.0f;
-    if (type == TowerType::ICE) return 180.0f;
-    return 100.0f;
+// Stretches a registered texture over the whole game screen. Returns false if it is not available (missing file).
+bool DrawScreenTexture(TextureHandle handle, int width, int height, Color tint) {
+    const Texture2D& tex = AssetRegistry::Get(handle);
+    if (tex.id == 0) return false;
+    Renderer::DrawTexturePro(tex, { 0, 0, (float)tex.width, (float)tex.height }, { 0, 0, (float)width, (float)height }, { 0, 0 }, 0.0f, tint);
+    return true;
 }
 
-int GetTowerCost(TowerType type) {
-    if (type == TowerType::ARCHER) return 100;
-    if (type == TowerType::ICE) return 150;
-    return 100;
-}
+// Texture memory above which unused textures are evicted, and audio memory above which a warning is logged.
+const size_t VRAM_BUDGET = 256u * 1024 * 1024;
+const size_t RAM_BUDGET = 128u * 1024 * 1024;
 
-/* Manages the lifecycle of blood effects.Iterates through active particles, updates animation frames based on delta time, and automatically culls
-inactive particles from the vector to manage memory.*/
-struct BloodParticle { Vector2 position; int currentFrame; float animTimer; bool active; };
-class BloodManager {
-public:
-    std::vector<BloodParticle> particles; Texture2D texture; int framesPerRow;
-    BloodManager() { framesPerRow = 4; }
-    void Init(Texture2D tex, int frames) { texture = tex; framesPerRow = frames; }
-    void Spawn(Vector2 pos) { particles.push_back({ pos, 0, 0.0f, true }); }
-    void Update(float dt) {
-        for (int i = 0; i < particles.size(); i++) {
-            if (!particles[i].active) continue;
-            particles[i].animTimer += dt;
-            if (particles[i].animTimer >= 0.08f) {
-                particles[i].animTimer = 0.0f; particles[i].currentFrame++;
-                if (particles[i].currentFrame >= framesPerRow) { particles[i].active = false; particles.erase(particles.begin() + i); i--; }
-            }
-        }
-    }
-    void Draw() {
-        if (texture.id <= 0) return;
-        float frameWidth = (float)texture.width / framesPerRow;
-        for (const auto& p : particles) {
-            Rectangle source = { p.currentFrame * frameWidth, 0, frameWidth, (float)texture.height };
-            Rectangle dest = { p.position.x, p.position.y, frameWidth, (float)texture.height };
-            Vector2 origin = { frameWidth / 2, (float)texture.height / 2 };
-            DrawTexturePro(texture, source, dest, origin, 0.0f, WHITE);
-        }
-    }
-};
 
-struct Rohirrim {
-    Vector2 position; std::vector<Vector2>* path; int currentPoint; bool active;
-    const std::vector<Texture2D>* frames; float animTimer; int currentFrameIndex;
-    Rohirrim(std::vector<Vector2>* p, const std::vector<Texture2D>* animFrames) {
-        path = p; frames = animFrames; currentPoint = (int)path->size() - 1; position = (*path)[currentPoint]; active = true; animTimer = 0.0f; currentFrameIndex = 0;
-    }
-    void Update(float dt) {
-        if (!active) return;
-        float speed = 350.0f; animTimer += dt;
-        if (animTimer >= 0.08f) { animTimer = 0.0f; currentFrameIndex++; if (currentFrameIndex >= frames->size()) currentFrameIndex = 0; }
-        if (currentPoint > 0) {
-            Vector2 target = (*path)[currentPoint - 1];
-            Vector2 dir = Vector2Normalize(Vector2Subtract(target, position));
-            position = Vector2Add(position, Vector2Scale(dir, speed * dt));
-            if (Vector2Distance(position, target) < 15.0f) currentPoint--;
-        }
-        else { active = false; }
-    }
-    void Draw() {
-        if (!active || frames->empty()) return;
-        Texture2D currentTex = (*frames)[currentFrameIndex];
-        Rectangle source = { 0, 0, (float)currentTex.width, (float)currentTex.height };
-        Rectangle dest = { position.x, position.y, 80, 80 }; Vector2 origin = { 40, 40 };
-        DrawTexturePro(currentTex, source, dest, origin, 0.0f, WHITE);
-    }
-};
-
-const int MAX_BLOOD = 100;
-const int COST_GANDALF = 40;
-const int COST_ROHIRRIM = 60;
-
-
-int main(void)
+int main(int argc, char** argv)
 {
-    
+    BenchmarkOptions benchOptions;
+    if (ParseBenchmarkArgs(argc, argv, benchOptions)) return RunBenchmark(benchOptions);
+
     const int gameScreenWidth = 1280;
     const int gameScreenHeight = 720;
 
@@ -227,237 +95,216 @@ int main(void)
     RenderTexture2D target = LoadRenderTexture(gameScreenWidth, gameScreenHeight);
     SetTextureFilter(target.texture, TEXTURE_FILTER_BILINEAR);
 
-   
-    Audio::LoadMusic("music_menu", "assets/sounds/menu_theme.mp3");
-    Audio::LoadMusic("music_level1", "assets/sounds/music_level1.mp3");
-    Audio::LoadMusic("music_level2", "assets/sounds/music_level2.wav");
-    Audio::LoadMusic("music_level3", "assets/sounds/music_level3.mp3");
-    Audio::LoadMusic("game_over", "assets/sounds/game_over.mp3");
-    Audio::LoadMusic("victory_jingle", "assets/sounds/victory_jingle.wav");
-    Audio::LoadMusic("music_boss", "assets/sounds/nazgul_boss.mp3");
-
-    Audio::LoadSFX("arrow_shoot", "assets/sounds/arrow_shoot.wav");
-    Audio::LoadSFX("ice_shoot", "assets/sounds/ice_shoot.wav");
-    Audio::LoadSFX("arrow_hit", "assets/sounds/arrow_hit.wav");
-    Audio::LoadSFX("ice_hit", "assets/sounds/ice_hit.wav");
-    Audio::LoadSFX("magic_shoot", "assets/sounds/magic.wav");
-    Audio::LoadSFX("sword_hit", "assets/sounds/spear_hit.wav");
-    Audio::LoadSFX("orc_death", "assets/sounds/orc_death.wav");
-    Audio::LoadSFX("build_tower", "assets/sounds/build.wav");
-    Audio::LoadSFX("ui_click", "assets/sounds/click.wav");
-    Audio::LoadSFX("gold_gain", "assets/sounds/gold_gain.wav");
-
-    Audio::LoadSFX("spawn_1", "assets/sounds/orc_spawn_1.wav");
-    Audio::LoadSFX("spawn_2", "assets/sounds/orc_spawn_2.wav");
-    Audio::LoadSFX("spawn_3", "assets/sounds/orc_spawn_3.wav");
-
-    Audio::LoadSFX("gandalf", "assets/sounds/gandalf_spell.wav");
-    Audio::LoadSFX("rohirrim", "assets/sounds/rohirrim_charge.mp3");
-    Audio::LoadSFX("victory", "assets/sounds/victory.wav");
-
-    Audio::LoadSFX("orc_walk", "assets/sounds/orc_walk.wav");
-    Audio::LoadSFX("heavy_walk", "assets/sounds/grond_walk.wav");
-
-   
-    Texture2D texMenuBg = LoadTexture("assets/ui/menu_bg.png");
-    Texture2D texVictoryBg = LoadTexture("assets/ui/victory_bg.png");
-    Texture2D texDefeatBg = LoadTexture("assets/ui/defeat_bg.png");
-
-    Texture2D texBtnNormal = LoadTexture("assets/ui/btn_default.png");
-    Texture2D texBtnHover = LoadTexture("assets/ui/btn_hover.png");
-
-    Texture2D texOrc = LoadTexture("assets/sprites/enemies/orc.png");
-    Texture2D texUruk = LoadTexture("assets/sprites/enemies/uruk.png");
-    Texture2D texTroll = LoadTexture("assets/sprites/enemies/troll.png");
-    Texture2D texGrond = LoadTexture("assets/sprites/enemies/grond.png");
-    Texture2D texCommander = LoadTexture("assets/sprites/enemies/commander.png");
-    Texture2D texNazgul = LoadTexture("assets/sprites/enemies/nazgul.png");
-
-    Texture2D texRoad = LoadTexture("assets/sprites/environment/road_texture.png");
-    Texture2D texCity = LoadTexture("assets/sprites/environment/minastirith_city.png");
-
-    Texture2D texTowerArcher = LoadTexture("assets/sprites/towers/tower_archer.png");
-    Texture2D texTowerMelee = LoadTexture("assets/sprites/towers/tower_melee.png");
-    Texture2D texTowerIce = LoadTexture("assets/sprites/towers/tower_ice.png");
-
-    Texture2D texProjArrow = LoadTexture("assets/sprites/projectiles/arrow_sheet.png");
-    Texture2D texProjIce = LoadTexture("assets/sprites/projectiles/ice_sheet.png");
-    Texture2D texProjMelee = LoadTexture("assets/sprites/projectiles/melee_fx.png");
-
-    Texture2D texBlood = LoadTexture("assets/sprites/effects/blood_strip.png");
-    Texture2D texGandalf = LoadTexture("assets/sprites/gandalf.png");
-
-    std::vector<Texture2D> rohirrimFrames;
-    rohirrimFrames.push_back(LoadTexture("assets/sprites/Knight_gallop1.png"));
-    rohirrimFrames.push_back(LoadTexture("assets/sprites/Knight_gallop2.png"));
-    rohirrimFrames.push_back(LoadTexture("assets/sprites/Knight_gallop3.png"));
-    rohirrimFrames.push_back(LoadTexture("assets/sprites/Knight_gallop4.png"));
-    rohirrimFrames.push_back(LoadTexture("assets/sprites/Knight_gallop5.png"));
+    /* ASSET LOADING :
+     Everything below is only queued. Worker threads decode the files while the loading screen
+     further down keeps the window responsive and uploads finished images/sounds each frame.*/
+    AssetLoader loader;
+    AssetArchive archive;
+    if (archive.Open("assets.pak")) {
+        loader.SetArchive(&archive);
+        TraceLog(LOG_INFO, "ASSETS: using assets.pak (%d entries)", archive.GetEntryCount());
+    }
+    // Decoded pixels of every texture, so warm starts skip PNG decoding (see TextureCache.h).
+    TextureCache textureCache;
+    if (textureCache.Open("cache/textures")) loader.SetTextureCache(&textureCache);
+    loader.QueueMusic("music_menu", "assets/sounds/menu_theme.mp3");
+    loader.QueueMusic("game_over", "assets/sounds/game_over.mp3");
+    loader.QueueMusic("victory_jingle", "assets/sounds/victory_jingle.wav");
+
+    loader.QueueSound("arrow_shoot", "assets/sounds/arrow_shoot.wav");
+    loader.QueueSound("ice_shoot", "assets/sounds/ice_shoot.wav");
+    loader.QueueSound("arrow_hit", "assets/sounds/arrow_hit.wav");
+    loader.QueueSound("ice_hit", "assets/sounds/ice_hit.wav");
+    loader.QueueSound("magic_shoot", "assets/sounds/magic.wav");
+    loader.QueueSound("sword_hit", "assets/sounds/spear_hit.wav");
+    loader.QueueSound("orc_death", "assets/sounds/orc_death.wav");
+    loader.QueueSound("build_tower", "assets/sounds/build.wav");
+    loader.QueueSound("ui_click", "assets/sounds/click.wav");
+    loader.QueueSound("gold_gain", "assets/sounds/gold_gain.wav");
+
+    loader.QueueSound("spawn_1", "assets/sounds/orc_spawn_1.wav");
+    loader.QueueSound("spawn_2", "assets/sounds/orc_spawn_2.wav");
+    loader.QueueSound("spawn_3", "assets/sounds/orc_spawn_3.wav");
+
+    loader.QueueSound("gandalf", "assets/sounds/gandalf_spell.wav");
+    loader.QueueSound("rohirrim", "assets/sounds/rohirrim_charge.mp3");
+    loader.QueueSound("victory", "assets/sounds/victory.wav");
+
+    loader.QueueSound("orc_walk", "assets/sounds/orc_walk.wav");
+    loader.QueueSound("heavy_walk", "assets/sounds/grond_walk.wav");
+
+    /* TEXTURES :
+     Every texture is registered in the AssetRegistry, which owns it and unloads it at exit. The
+     variables below are weak handles; entities keep TextureRefs to the sprites they draw. The few
+     textures that are copied by value into long-lived objects (Hud, buttons, blood emitter) are held
+     as TextureRefs here, so they can never be evicted under those copies.*/
+    auto queueTexture = [&](const char* path, AssetClass cls) {
+        TextureHandle handle = AssetRegistry::RegisterTexture(path, cls);
+        loader.QueueTexture(AssetRegistry::GetLoadTarget(handle), path);
+        return handle;
+    };
+    TextureHandle texMenuBg = queueTexture("assets/ui/menu_bg.png", AssetClass::UI);
+    TextureHandle texVictoryBg = queueTexture("assets/ui/victory_bg.png", AssetClass::UI);
+    TextureHandle texDefeatBg = queueTexture("assets/ui/defeat_bg.png", AssetClass::UI);
+
+    TextureRef texBtnNormalRef = queueTexture("assets/ui/btn_default.png", AssetClass::UI);
+    TextureRef texBtnHoverRef = queueTexture("assets/ui/btn_hover.png", AssetClass::UI);
+
+    TextureHandle texOrc = queueTexture("assets/sprites/enemies/orc.png", AssetClass::ENEMY);
+    TextureHandle texUruk = queueTexture("assets/sprites/enemies/uruk.png", AssetClass::ENEMY);
+    TextureHandle texTroll = queueTexture("assets/sprites/enemies/troll.png", AssetClass::ENEMY);
+    TextureHandle texGrond = queueTexture("assets/sprites/enemies/grond.png", AssetClass::ENEMY);
+    TextureHandle texCommander = queueTexture("assets/sprites/enemies/commander.png", AssetClass::ENEMY);
+    TextureHandle texNazgul = queueTexture("assets/sprites/enemies/nazgul.png", AssetClass::ENEMY);
+
+    TextureHandle texRoad = queueTexture("assets/sprites/environment/road_texture.png", AssetClass::ENVIRONMENT);
+    TextureHandle texCity = queueTexture("assets/sprites/environment/minastirith_city.png", AssetClass::ENVIRONMENT);
+
+    TextureHandle texTowerArcher = queueTexture("assets/sprites/towers/tower_archer.png", AssetClass::TOWER);
+    TextureHandle texTowerMelee = queueTexture("assets/sprites/towers/tower_melee.png", AssetClass::TOWER);
+    TextureHandle texTowerIce = queueTexture("assets/sprites/towers/tower_ice.png", AssetClass::TOWER);
+
+    TextureHandle texProjArrow = queueTexture("assets/sprites/projectiles/arrow_sheet.png", AssetClass::PROJECTILE);
+    TextureHandle texProjIce = queueTexture("assets/sprites/projectiles/ice_sheet.png", AssetClass::PROJECTILE);
+    TextureHandle texProjMelee = queueTexture("assets/sprites/projectiles/melee_fx.png", AssetClass::PROJECTILE);
+
+    TextureRef texBloodRef = queueTexture("assets/sprites/effects/blood_strip.png", AssetClass::EFFECT);
+    TextureHandle texGandalf = queueTexture("assets/sprites/gandalf.png", AssetClass::EFFECT);
+
+    std::vector<TextureRef> rohirrimFrames;
+    rohirrimFrames.push_back(queueTexture("assets/sprites/Knight_gallop1.png", AssetClass::EFFECT));
+    rohirrimFrames.push_back(queueTexture("assets/sprites/Knight_gallop2.png", AssetClass::EFFECT));
+    rohirrimFrames.push_back(queueTexture("assets/sprites/Knight_gallop3.png", AssetClass::EFFECT));
+    rohirrimFrames.push_back(queueTexture("assets/sprites/Knight_gallop4.png", AssetClass::EFFECT));
+    rohirrimFrames.push_back(queueTexture("assets/sprites/Knight_gallop5.png", AssetClass::EFFECT));
 
     Camera2D camera = { 0 }; camera.zoom = 1.0f;
-    std::vector<LevelData> allLevels;
+    std::vector<LevelData> allLevels = CreateLevels();
 
-   
-    {
-        LevelData lvl; lvl.levelID = 1; lvl.name = "Level 1: Outskirts";
-        lvl.background = LoadTexture("assets/sprites/environment/minastirith_bg.png");
-        lvl.bgColor = DARKGREEN;
-        lvl.startGold = 400;
-        int width = 30; lvl.cols = width; lvl.mapWidth = width * TILE_SIZE;
-        lvl.castlePos = { 1550.0f, 120.0f }; lvl.castleScale = 0.5f;
-        int design[12][30] = {
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {2,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,3,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
-        };
-        lvl.tileMap.resize(MAP_ROWS);
-        for (int y = 0; y < MAP_ROWS; y++) { lvl.tileMap[y].resize(width); for (int x = 0; x < width; x++) lvl.tileMap[y][x] = design[y][x]; }
-        lvl.paths = GeneratePathsFromMap(lvl.tileMap);
-
-        lvl.waves.push_back({ 5, EnemyType::ORC, 1.5f, 1.0f, 0 });
-        lvl.waves.push_back({ 12, EnemyType::ORC, 1.0f, 1.1f, 0 });
-        lvl.waves.push_back({ 5, EnemyType::URUK, 2.0f, 0.9f, 10 });
-        lvl.waves.push_back({ 15, EnemyType::ORC, 0.8f, 1.2f, 5 });
-        lvl.waves.push_back({ 15, EnemyType::URUK, 1.5f, 1.0f, 20 });
-
-        lvl.storyLines = {
-            "CHAPTER 1: THE OUTSKIRTS",
-            "Scouts report Orc activity near the farm lands.",
-            "They are testing our defenses.",
-            "Hold them off before they reach the main gate."
-        };
-        allLevels.push_back(lvl);
-    }
+    /* PER-LEVEL RESOURCES :
+     Level backgrounds and level music are not part of the startup load. Only the level being played
+     is resident: it is prefetched when picked in LEVEL_SELECT and released when the run ends.*/
+    LevelResources levelResources;
+    levelResources.SetSources(archive.IsOpen() ? &archive : nullptr, textureCache.IsOpen() ? &textureCache : nullptr);
 
-    
-    {
-        LevelData lvl; lvl.levelID = 2; lvl.name = "Level 2: Long Road";
-        lvl.background = LoadTexture("assets/sprites/environment/lvl2_bg.png");
-        lvl.bgColor = DARKGREEN;
-        lvl.startGold = 600;
-        int width = 30; lvl.cols = width; lvl.mapWidth = width * TILE_SIZE;
-        lvl.castlePos = { 1550.0f, 120.0f }; lvl.castleScale = 0.5f;
-        int design[12][30] = {
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {2,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,1,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,1,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,3,0,0,0,0},
-            {2,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
-        };
-        lvl.tileMap.resize(MAP_ROWS);
-        for (int y = 0; y < MAP_ROWS; y++) { lvl.tileMap[y].resize(width); for (int x = 0; x < width; x++) lvl.tileMap[y][x] = design[y][x]; }
-        lvl.paths = GeneratePathsFromMap(lvl.tileMap);
-
-        lvl.waves.push_back({ 10, EnemyType::ORC, 1.0f, 1.1f, 5 });
-        lvl.waves.push_back({ 8, EnemyType::URUK, 1.5f, 1.0f, 10 });
-        lvl.waves.push_back({ 2, EnemyType::COMMANDER, 2.0f, 1.0f, 0 });
-        lvl.waves.push_back({ 4, EnemyType::TROLL, 5.0f, 1.0f, 20 });
-        lvl.waves.push_back({ 3, EnemyType::GROND, 5.0f, 1.0f, 50 });
-
-        lvl.storyLines = {
-            "CHAPTER 2: THE LONG ROAD",
-            "Osgiliath has fallen.",
-            "The enemy is marching towards the Great River.",
-            "Ambush their vanguards on the road!",
-            "Beware of the Trolls."
-        };
-        allLevels.push_back(lvl);
-    }
+    /* LOADING SCREEN :
+     Runs until every queued asset is on the GPU / in the audio device. Uploads get a few milliseconds
+     per frame so the progress bar keeps animating even while big textures are being created.*/
+    loader.Start();
+    while (!loader.IsDone() && !WindowShouldClose()) {
+        loader.UploadPending(4.0);
 
-    
-    {
-        LevelData lvl; lvl.levelID = 3; lvl.name = "Level 3: The Siege";
-        lvl.background = LoadTexture("assets/sprites/environment/lvl3_bg.png");
-        lvl.bgColor = DARKGREEN;
-        lvl.startGold = 700;
-        int width = 50; lvl.cols = width; lvl.mapWidth = width * TILE_SIZE;
-        lvl.castlePos = { 2700.0f, 90.0f }; lvl.castleScale = 0.5f;
-        int design[12][50] = {
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {2,1,1,1,0,0,0,0,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,1,1,1,1,1,1,1,1,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,3,0,0,0,0,0,0},
-            {2,1,1,1,1,1,1,1,1,1,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,1,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0},
-            {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
-        };
-        lvl.tileMap.resize(MAP_ROWS);
-        for (int y = 0; y < MAP_ROWS; y++) { lvl.tileMap[y].resize(width); for (int x = 0; x < width; x++) lvl.tileMap[y][x] = design[y][x]; }
-        lvl.paths = GeneratePathsFromMap(lvl.tileMap);
-
-        lvl.waves.push_back({ 20, EnemyType::ORC, 0.8f, 1.0f, 10 });
-        lvl.waves.push_back({ 15, EnemyType::URUK, 1.0f, 1.1f, 20 });
-        lvl.waves.push_back({ 25, EnemyType::ORC, 0.6f, 1.1f, 15 });
-        lvl.waves.push_back({ 6,  EnemyType::TROLL, 4.0f, 1.0f, 50 });
-        lvl.waves.push_back({ 25, EnemyType::URUK, 0.7f, 1.3f, 30 }); 
-        lvl.waves.push_back({ 5, EnemyType::COMMANDER, 2.0f, 1.0f, 0 });
-        lvl.waves.push_back({ 3, EnemyType::GROND, 5.0f, 1.0f, 100 });
-        lvl.waves.push_back({ 1,  EnemyType::NAZGUL, 5.0f, 1.5f, 500 });
-
-        lvl.storyLines = {
-            "CHAPTER 3: THE SIEGE BEGINS",
-            "The sky turns red as the Great Eye turns toward us.",
-            "The Witch King comes to claim Gondor.",
-            "This is our final stand.",
-            "YOU SHALL NOT PASS!"
-        };
-        allLevels.push_back(lvl);
+        BeginDrawing();
+        Renderer::ClearBackground(BLACK);
+        float progress = loader.GetProgress();
+        int barW = 600; int barX = (GetScreenWidth() - barW) / 2; int barY = GetScreenHeight() / 2;
+        TextCache::Draw("LOADING", (GetScreenWidth() - TextCache::Measure("LOADING", 40)) / 2, barY - 70, 40, GOLD);
+        Renderer::DrawRectangleLines(barX, barY, barW, 24, GRAY);
+        Renderer::DrawRectangle(barX + 2, barY + 2, (int)((barW - 4) * progress), 20, MAROON);
+        EndDrawing();
+    }
+    loader.Finish();
+    Texture2D texBtnNormal = texBtnNormalRef.Get();
+    Texture2D texBtnHover = texBtnHoverRef.Get();
+    Texture2D texBlood = texBloodRef.Get();
+    AssetRegistry::SetSources(archive.IsOpen() ? &archive : nullptr, textureCache.IsOpen() ? &textureCache : nullptr);
+    AssetRegistry::SetBudget(VRAM_BUDGET, RAM_BUDGET);
+
+    /* SFX LIMITS :
+     Combat sounds fire in bursts, so they get few voices and low priority; the ability and UI sounds
+     are never cut off by them. Sounds not listed keep the defaults (4 voices, priority 1).*/
+    Audio::SetSFXLimits(SoundId::ARROW_SHOOT, 3, 0);
+    Audio::SetSFXLimits(SoundId::ARROW_HIT, 3, 0);
+    Audio::SetSFXLimits(SoundId::ICE_SHOOT, 2, 0);
+    Audio::SetSFXLimits(SoundId::ICE_HIT, 2, 0);
+    Audio::SetSFXLimits(SoundId::SWORD_HIT, 3, 0);
+    Audio::SetSFXLimits(SoundId::ORC_DEATH, 3, 0);
+    Audio::SetSFXLimits(SoundId::GOLD_GAIN, 2, 0);
+    Audio::SetSFXLimits(SoundId::SPAWN_1, 1, 0);
+    Audio::SetSFXLimits(SoundId::SPAWN_2, 1, 0);
+    Audio::SetSFXLimits(SoundId::SPAWN_3, 1, 0);
+    Audio::SetSFXLimits(SoundId::ORC_WALK, 1, 1);
+    Audio::SetSFXLimits(SoundId::HEAVY_WALK, 2, 1);
+    Audio::SetSFXLimits(SoundId::BUILD_TOWER, 2, 2);
+    Audio::SetSFXLimits(SoundId::GANDALF, 1, 3);
+    Audio::SetSFXLimits(SoundId::ROHIRRIM, 1, 3);
+    Audio::SetSFXLimits(SoundId::VICTORY, 1, 3);
+    Audio::SetSFXLimits(SoundId::UI_CLICK, 2, 3);
+    Audio::SetSFXBudget(8);
+    TraceLog(LOG_INFO, "ASSETS: %d assets loaded in %.0f ms (%.0f ms of decoding on worker threads)",
+        loader.GetTotal(), GetTime() * 1000.0, loader.GetDecodeMs());
+    if (textureCache.IsOpen()) {
+        TraceLog(LOG_INFO, "TEXCACHE: %d hits, %d misses (%d stale rebuilt), ~%.0f ms of decoding saved",
+            textureCache.GetHits(), textureCache.GetMisses(), textureCache.GetRebuilt(), textureCache.GetSavedMs());
     }
+    AssetRegistry::LogReport();
+    bool firstFrameReported = false;
 
     LevelData* currentLevel = nullptr;
     GameScreen currentScreen = GameScreen::TITLE;
 
-    std::vector<Enemy> enemies;
-    std::vector<Tower> towers;
-    std::vector<Projectile> projectiles;
-    std::vector<Rohirrim> riders;
-    BloodManager bloodSystem; bloodSystem.Init(texBlood, 4);
-
-    float spawnTimer = 0.0f;
-    int gold = 0;
-    int currentWaveIndex = 0;
-    int enemiesSpawnedInWave = 0;
-    float waveDelayTimer = 0.0f;
+    World world;
+    /* PARTICLE EMITTERS :
+     Blood keeps its old look (4-frame strip, 0.08 s per frame). Ice shatter, Gandalf's sparks and the
+     Rohirrim dust are flat colored particles, so they need no extra textures.*/
+    ParticleSystem particles;
+    particles.SetBudget(4000);
+    particles.Configure(EmitterType::BLOOD, { texBlood, 4, 0.08f, 0.32f, 1, 0.0f, 0.0f, 0.0f, 0.0f, WHITE, false, RenderLayer::DECALS });
+    particles.Configure(EmitterType::ICE_SHATTER, { { 0 }, 1, 0.1f, 0.4f, 6, 60.0f, 140.0f, 250.0f, 4.0f, SKYBLUE, true, RenderLayer::AIR });
+    particles.Configure(EmitterType::GANDALF_SPARK, { { 0 }, 1, 0.1f, 0.8f, 4, 40.0f, 120.0f, -60.0f, 3.0f, RAYWHITE, true, RenderLayer::AIR });
+    particles.Configure(EmitterType::ROHIRRIM_DUST, { { 0 }, 1, 0.1f, 0.6f, 1, 10.0f, 30.0f, -20.0f, 6.0f, Color{ 160, 130, 90, 160 }, true, RenderLayer::DECALS });
+    world.SetParticles(&particles);
+    world.SetEnemyTexture(EnemyType::ORC, texOrc);
+    world.SetEnemyTexture(EnemyType::URUK, texUruk);
+    world.SetEnemyTexture(EnemyType::TROLL, texTroll);
+    world.SetEnemyTexture(EnemyType::GROND, texGrond);
+    world.SetEnemyTexture(EnemyType::COMMANDER, texCommander);
+    world.SetEnemyTexture(EnemyType::NAZGUL, texNazgul);
+    world.SetTowerTextures(TowerType::ARCHER, texTowerArcher, texProjArrow);
+    world.SetTowerTextures(TowerType::MELEE, texTowerMelee, texProjMelee);
+    world.SetTowerTextures(TowerType::ICE, texTowerIce, texProjIce);
+    // The banner, catapult and lightning towers have no sprites; Tower::Draw() and Projectile::Draw() draw them from primitives.
+    world.SetTowerTextures(TowerType::BANNER, TextureHandle(), TextureHandle());
+    world.SetTowerTextures(TowerType::CATAPULT, TextureHandle(), TextureHandle());
+    world.SetTowerTextures(TowerType::LIGHTNING, TextureHandle(), TextureHandle());
+    world.SetRiderFrames(&rohirrimFrames);
+    // Quick save (F5) / quick load (F9) of the level in progress; the buffer is reused between saves.
+    const char* quickSavePath = "quicksave.sav";
+    std::vector<unsigned char> snapshotBuffer;
+    /* REWIND :
+     The last five minutes of play are kept as one snapshot per second, within a byte budget; the horde
+     level keeps less (see HistoryConfigFor in SnapshotHistory.h). F6 rewinds 10 s (Shift+F6: 60 s).
+     F7 jumps back to the start of the current wave; pressed again right after, it goes one more wave back.
+     The history is configured when a level is chosen.*/
+    SnapshotHistory history;
+    WorldRenderList renderList;
+    Hud hud; hud.Init(gameScreenWidth, gameScreenHeight, texBtnNormal, texBtnHover, MAX_BLOOD, COST_GANDALF, COST_ROHIRRIM);
+
     TowerType selectedTower = TowerType::ARCHER;
-    int urukBlood = 0;
     float flashTimer = 0.0f;
     float bossLabelTimer = 0.0f;
 
-    int castleHealth = 100;
-    bool isBossActive = false;
-    const int CASTLE_MAX_HEALTH = 100;
-
-    float walkSoundTimer = 0.0f;
+    /* PERF READOUT :
+     F3 toggles frame timings and entity counts in the corner; on by default in the horde level. The numbers
+     are averaged over half a second so they can be read while they change.*/
+    bool showPerf = false;
+    float perfTimer = 0.0f;
+    int perfFrames = 0;
+    double perfSimMs = 0.0, perfRenderMs = 0.0;
+    // Simulation and history recording done inside the frame being timed; Renderer's cpuMs covers the previous
+    // frame, so the render figure subtracts 'lastFrameWorkMs'.
+    double frameWorkMs = 0.0, lastFrameWorkMs = 0.0;
+    int perfSimUs = 0, perfRenderUs = 0;
     float introAlpha = 0.0f;
     int introState = 0;
     float introTimer = 0.0f;
     int introTextIndex = 0;
+    bool quitRequested = false;   // EXIT finishes the frame, then leaves through the shutdown below.
 
     /* MAIN GAME LOOP :
     Uses Delta Time (dt) for all movement calculations to ensure the game runs 
     at the same speed on high refresh rate monitors (144hz+) as it does on 60hz.*/
-    while (!WindowShouldClose())
+    while (!WindowShouldClose() && !quitRequested)
     {
         float dt = GetFrameTime();
 
@@ -493,41 +340,64 @@ int main(void)
             }
         }
 
-        Audio::Update();
 
-        
-        BeginTextureMode(target);
-        ClearBackground(RAYWHITE);
+        lastFrameWorkMs = frameWorkMs;
+        frameWorkMs = 0.0;
+        Renderer::BeginFrame();
+        Renderer::BeginTextureMode(target);
+        Renderer::ClearBackground(RAYWHITE);
 
         
         switch (currentScreen)
         {
         case GameScreen::TITLE:
         case GameScreen::LEVEL_SELECT:
+            // Leaving a level by any route (menu button, victory, defeat) ends up here. The end screens keep
+            // the level's tracks loaded, they are still fading out under the jingle.
+            levelResources.Release();
+            Audio::PlayMusic(MusicId::MENU);
+            Audio::SetMusicVolume(0.3f);
+            break;
+
         case GameScreen::LEVEL_INTRO:
-            Audio::PlayMusic("music_menu");
+            levelResources.Pump(2.0);
+            Audio::PlayMusic(MusicId::MENU);
             Audio::SetMusicVolume(0.3f);
             break;
 
         case GameScreen::GAMEPLAY:
-            if (isBossActive) {
-                Audio::PlayMusic("music_boss");
+            levelResources.Acquire();
+            if (world.isBossActive) {
+                Audio::PlayMusic(MusicId::BOSS);
                 Audio::SetMusicVolume(0.4f);
             }
             else {
-                if (currentLevel->levelID == 1) Audio::PlayMusic("music_level1");
-                else if (currentLevel->levelID == 2) Audio::PlayMusic("music_level2");
-                else if (currentLevel->levelID == 3) Audio::PlayMusic("music_level3");
+                if (currentLevel->levelID == 1) Audio::PlayMusic(MusicId::LEVEL1);
+                else if (currentLevel->levelID == 2) Audio::PlayMusic(MusicId::LEVEL2);
+                else Audio::PlayMusic(MusicId::LEVEL3);
                 Audio::SetMusicVolume(0.2f);
             }
+            /* MUSIC PREFETCH :
+             The audio thread primes the track we are most likely to switch to next, so the switch is a
+             crossfade from already-decoded audio: the boss theme while the Nazgul wave is running or next,
+             the defeat theme once the castle is nearly down, the victory jingle during the last wave.*/
+            {
+                EnemyWave nextWave;
+                bool hasNextWave = world.PeekWave(world.currentWaveIndex + 1, nextWave);
+                bool bossAhead = (world.hasWave && world.currentWave.enemyType == EnemyType::NAZGUL) ||
+                    (hasNextWave && nextWave.enemyType == EnemyType::NAZGUL);
+                if (world.castleHealth <= CASTLE_MAX_HEALTH / 4) Audio::PrefetchMusic(MusicId::GAME_OVER);
+                else if (bossAhead && !world.isBossActive) Audio::PrefetchMusic(MusicId::BOSS);
+                else if (!hasNextWave) Audio::PrefetchMusic(MusicId::VICTORY_JINGLE);
+            }
             break;
 
         case GameScreen::VICTORY:
-            Audio::PlayMusic("victory_jingle");
+            Audio::PlayMusic(MusicId::VICTORY_JINGLE);
             break;
 
         case GameScreen::GAMEOVER:
-            Audio::PlayMusic("game_over");
+            Audio::PlayMusic(MusicId::GAME_OVER);
             break;
         }
 
@@ -538,19 +408,17 @@ int main(void)
         switch (currentScreen)
         {
         case GameScreen::TITLE:
-            if (texMenuBg.id > 0) DrawTexturePro(texMenuBg, { 0,0,(float)texMenuBg.width, (float)texMenuBg.height }, { 0,0,(float)gameScreenWidth, (float)gameScreenHeight }, { 0,0 }, 0, WHITE);
-            else DrawRectangleGradientV(0, 0, gameScreenWidth, gameScreenHeight, DARKBLUE, BLACK);
-            DrawText("SIEGE OF GONDOR", gameScreenWidth / 2 - MeasureText("SIEGE OF GONDOR", 60) / 2, 150, 60, GOLD);
+            if (!DrawScreenTexture(texMenuBg, gameScreenWidth, gameScreenHeight, WHITE)) Renderer::DrawRectangleGradientV(0, 0, gameScreenWidth, gameScreenHeight, DARKBLUE, BLACK);
+            TextCache::Draw("SIEGE OF GONDOR", gameScreenWidth / 2 - TextCache::Measure("SIEGE OF GONDOR", 60) / 2, 150, 60, GOLD);
 
            
             if (GuiButton({ (float)gameScreenWidth / 2 - 100, 400, 200, 50 }, "PLAY GAME", texBtnNormal, texBtnHover, mouseScreenPos)) currentScreen = GameScreen::LEVEL_SELECT;
-            if (GuiButton({ (float)gameScreenWidth / 2 - 100, 470, 200, 50 }, "EXIT", texBtnNormal, texBtnHover, mouseScreenPos)) { CloseWindow(); return 0; }
+            if (GuiButton({ (float)gameScreenWidth / 2 - 100, 470, 200, 50 }, "EXIT", texBtnNormal, texBtnHover, mouseScreenPos)) quitRequested = true;
             break;
 
         case GameScreen::LEVEL_SELECT:
-            if (texMenuBg.id > 0) DrawTexturePro(texMenuBg, { 0,0,(float)texMenuBg.width, (float)texMenuBg.height }, { 0,0,(float)gameScreenWidth, (float)gameScreenHeight }, { 0,0 }, 0, GRAY);
-            else DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, DARKGRAY);
-            DrawText("SELECT A BATTLEFIELD", gameScreenWidth / 2 - MeasureText("SELECT A BATTLEFIELD", 40) / 2, 50, 40, WHITE);
+            if (!DrawScreenTexture(texMenuBg, gameScreenWidth, gameScreenHeight, GRAY)) Renderer::DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, DARKGRAY);
+            TextCache::Draw("SELECT A BATTLEFIELD", gameScreenWidth / 2 - TextCache::Measure("SELECT A BATTLEFIELD", 40) / 2, 50, 40, WHITE);
             {
                 int btnWidth = 300; int btnHeight = 60; int gap = 10; int startY = 120;
                 for (int i = 0; i < allLevels.size(); i++) {
@@ -559,12 +427,12 @@ int main(void)
                     
                     if (GuiButton({ x, y, (float)btnWidth, (float)btnHeight }, allLevels[i].name, texBtnNormal, texBtnHover, mouseScreenPos)) {
                         currentLevel = &allLevels[i];
-                        gold = currentLevel->startGold;
-                        castleHealth = CASTLE_MAX_HEALTH;
-                        enemies.clear(); towers.clear(); projectiles.clear(); riders.clear(); bloodSystem.particles.clear();
-                        currentWaveIndex = 0; enemiesSpawnedInWave = 0; waveDelayTimer = 0.0f; urukBlood = 0;
+                        levelResources.Prefetch(*currentLevel);
+                        world.Reset(currentLevel, (unsigned long long)time(nullptr));
+                        history.Configure(HistoryConfigFor(*currentLevel));
+                        particles.Clear();
                         camera.target = { 0, 0 };
-                        isBossActive = false;
+                        showPerf = currentLevel->horde;
                         currentScreen = GameScreen::LEVEL_INTRO;
                         introState = 0; introAlpha = 0.0f; introTimer = 0.0f; introTextIndex = 0;
                     }
@@ -575,7 +443,7 @@ int main(void)
 
         case GameScreen::LEVEL_INTRO:
         {
-            ClearBackground(BLACK);
+            Renderer::ClearBackground(BLACK);
             if (IsKeyPressed(KEY_ENTER) || IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) { currentScreen = GameScreen::GAMEPLAY; }
 
             float fadeSpeed = 0.5f; float holdTime = 2.5f;
@@ -597,10 +465,10 @@ int main(void)
 
             if (currentLevel && introTextIndex < currentLevel->storyLines.size()) {
                 const char* text = currentLevel->storyLines[introTextIndex].c_str();
-                int fontSize = 40; int textW = MeasureText(text, fontSize);
-                DrawText(text, (gameScreenWidth - textW) / 2, (gameScreenHeight - fontSize) / 2, fontSize, Fade(WHITE, introAlpha));
+                int fontSize = 40; int textW = TextCache::Measure(text, fontSize);
+                TextCache::Draw(text, (gameScreenWidth - textW) / 2, (gameScreenHeight - fontSize) / 2, fontSize, Fade(WHITE, introAlpha));
             }
-            DrawText("Press ENTER to Skip", gameScreenWidth - 250, gameScreenHeight - 40, 20, Fade(GRAY, 0.5f));
+            TextCache::Draw("Press ENTER to Skip", gameScreenWidth - 250, gameScreenHeight - 40, 20, Fade(GRAY, 0.5f));
         }
         break;
 
@@ -613,26 +481,55 @@ int main(void)
                 if (camera.target.x < 0) camera.target.x = 0;
                 if (camera.target.x > currentLevel->mapWidth - gameScreenWidth) camera.target.x = currentLevel->mapWidth - gameScreenWidth;
             }
-
-            if (IsKeyPressed(KEY_Q)) {
-                if (urukBlood >= COST_GANDALF) {
-                    urukBlood -= COST_GANDALF;
-                    flashTimer = 2.0f;
-                    Audio::PlaySFX("gandalf");
-                    for (Enemy& e : enemies) e.ApplyStun(3.0f);
+            // Positional sounds are heard from the middle of the view; half a screen away they start to fade.
+            Audio::SetListener({ camera.target.x + gameScreenWidth / 2.0f, camera.target.y + gameScreenHeight / 2.0f }, gameScreenWidth / 2.0f);
+
+            if (IsKeyPressed(KEY_Q) && world.CastGandalf()) {
+                flashTimer = 2.0f;
+                Audio::PlaySFX(SoundId::GANDALF);
+            }
+            if (IsKeyPressed(KEY_W) && world.CallRohirrim()) Audio::PlaySFX(SoundId::ROHIRRIM);
+            if (IsKeyPressed(KEY_F3)) showPerf = !showPerf;
+            if (IsKeyPressed(KEY_F5)) {
+                double start = GetTime();
+                world.SaveSnapshot(snapshotBuffer);
+                double saveMs = (GetTime() - start) * 1000.0;
+                if (WriteSnapshotFile(quickSavePath, snapshotBuffer)) TraceLog(LOG_INFO, "SNAPSHOT: saved %d bytes to %s (%.3f ms to serialize)", (int)snapshotBuffer.size(), quickSavePath, saveMs);
+                else TraceLog(LOG_WARNING, "SNAPSHOT: could not write %s", quickSavePath);
+            }
+            if (IsKeyPressed(KEY_F9)) {
+                // Only a save of the level being played is accepted; start that level first, then load.
+                if (ReadSnapshotFile(quickSavePath, snapshotBuffer) && world.LoadSnapshot(snapshotBuffer.data(), snapshotBuffer.size())) {
+                    particles.Clear();
+                    history.Clear();
+                    TraceLog(LOG_INFO, "SNAPSHOT: loaded %s (wave %d, %d enemies)", quickSavePath, world.currentWaveIndex + 1, (int)world.enemies.size());
+                }
+                else TraceLog(LOG_WARNING, "SNAPSHOT: %s is missing, from another version or from another level", quickSavePath);
+            }
+            if (IsKeyPressed(KEY_F6)) {
+                float wanted = (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) ? 60.0f : 10.0f;
+                float rewound = history.Rewind(world, wanted);
+                if (rewound >= 0.0f) {
+                    particles.Clear();
+                    TraceLog(LOG_INFO, "HISTORY: rewound %.1f s to wave %d", rewound, world.currentWaveIndex + 1);
                 }
             }
-            if (IsKeyPressed(KEY_W)) {
-                if (urukBlood >= COST_ROHIRRIM) {
-                    urukBlood -= COST_ROHIRRIM;
-                    Audio::PlaySFX("rohirrim");
-                    for (auto* path : currentLevel->paths) riders.emplace_back(path, &rohirrimFrames);
+            if (IsKeyPressed(KEY_F7)) {
+                int wave = world.currentWaveIndex;
+                if (history.GetSecondsSinceWaveStart() >= 0.0f && history.GetSecondsSinceWaveStart() < 2.0f) wave--;
+                if (wave >= 0 && history.JumpToWave(world, wave)) {
+                    particles.Clear();
+                    TraceLog(LOG_INFO, "HISTORY: jumped to the start of wave %d", wave + 1);
                 }
+                else TraceLog(LOG_WARNING, "HISTORY: the start of wave %d is no longer kept (oldest: %d)", wave + 1, history.GetOldestWave() + 1);
             }
 
             if (IsKeyPressed(KEY_ONE))   selectedTower = TowerType::ARCHER;
             if (IsKeyPressed(KEY_TWO))   selectedTower = TowerType::MELEE;
             if (IsKeyPressed(KEY_THREE)) selectedTower = TowerType::ICE;
+            if (IsKeyPressed(KEY_FOUR))  selectedTower = TowerType::BANNER;
+            if (IsKeyPressed(KEY_FIVE))  selectedTower = TowerType::CATAPULT;
+            if (IsKeyPressed(KEY_SIX))   selectedTower = TowerType::LIGHTNING;
 
             /* TOWER PLACEMENT LOGIC :
              1. Snaps the mouse position to the nearest grid tile.
@@ -650,157 +547,47 @@ int main(void)
 
             if (isHoveringUI) isValidPlacement = false;
             else {
-                if (gold < GetTowerCost(selectedTower)) isValidPlacement = false;
-                for (const Tower& t : towers) if (CheckCollisionPointCircle(snapPos, t.GetPosition(), 10.0f)) isValidPlacement = false;
+                if (world.gold < Tower::GetBuildCost(selectedTower)) isValidPlacement = false;
+                for (const Tower& t : world.towers) if (CheckCollisionPointCircle(snapPos, t.GetPosition(), 10.0f)) isValidPlacement = false;
             }
 
             if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                 bool clickedExisting = false;
-                for (Tower& t : towers) {
-                    if (t.IsClicked(mouseWorldPos)) {
+                for (int i = 0; i < (int)world.towers.size(); i++) {
+                    if (world.towers[i].IsClicked(mouseWorldPos)) {
                         clickedExisting = true;
-                        if (gold >= t.GetUpgradeCost()) { gold -= t.GetUpgradeCost(); t.Upgrade(); }
+                        world.UpgradeTower(i);
                         break;
                     }
                 }
-                if (!clickedExisting && isValidPlacement) {
-                    Texture2D textureToUse = texTowerArcher;
-                    Texture2D projectileToUse = texProjArrow;
-                    if (selectedTower == TowerType::MELEE) { textureToUse = texTowerMelee; projectileToUse = texProjMelee; }
-                    else if (selectedTower == TowerType::ICE) { textureToUse = texTowerIce; projectileToUse = texProjIce; }
-
-                    towers.emplace_back(snapPos, textureToUse, projectileToUse, selectedTower);
-                    Audio::PlaySFX("build_tower");
-                    gold -= GetTowerCost(selectedTower);
-                }
-            }
-
-            if (currentWaveIndex < currentLevel->waves.size()) {
-                EnemyWave& w = currentLevel->waves[currentWaveIndex];
-                if (enemiesSpawnedInWave < w.enemyCount) {
-                    spawnTimer += dt;
-                    if (spawnTimer >= w.spawnInterval) {
-                        spawnTimer = 0.0f;
-                        if (!currentLevel->paths.empty()) {
-                            int pathIndex = GetRandomValue(0, (int)currentLevel->paths.size() - 1);
-                            std::vector<Vector2>* chosenPath = currentLevel->paths[pathIndex];
-
-                            Texture2D currentEnemyTex = texOrc;
-                            if (w.enemyType == EnemyType::URUK) currentEnemyTex = texUruk;
-                            else if (w.enemyType == EnemyType::TROLL) currentEnemyTex = texTroll;
-                            else if (w.enemyType == EnemyType::GROND) currentEnemyTex = texGrond;
-                            else if (w.enemyType == EnemyType::NAZGUL) currentEnemyTex = texNazgul;
-                            else if (w.enemyType == EnemyType::COMMANDER) currentEnemyTex = texCommander;
-
-
-                            int dynamicHealth = w.healthBonus + (currentLevel->levelID * 15);
-                            enemies.push_back(Enemy(w.enemyType, chosenPath, currentEnemyTex, w.speedMultiplier, dynamicHealth));
-
-                            if (w.enemyType == EnemyType::NAZGUL) {
-                                isBossActive = true;
-                                bossLabelTimer = 4.0f;
-                            }
-
-                            int rndSpawn = GetRandomValue(1, 3);
-                            Audio::PlaySFX(TextFormat("spawn_%d", rndSpawn), 0.1f + GetRandomValue(-1, 1) / 10.0f);
-                            enemiesSpawnedInWave++;
-                        }
-                    }
-                }
-                else if (enemies.empty()) {
-                    waveDelayTimer += dt;
-                    if (waveDelayTimer > 3.0f) { currentWaveIndex++; enemiesSpawnedInWave = 0; waveDelayTimer = 0.0f; }
-                }
-            }
-            else {
-                if (enemies.empty()) {
-                    Audio::StopMusic();
-                    Audio::PlayMusic("victory_jingle");
-                    currentScreen = GameScreen::VICTORY;
-                }
-            }
-
-            if (!enemies.empty()) {
-                walkSoundTimer += dt;
-                if (walkSoundTimer > 0.6f) {
-                    walkSoundTimer = 0.0f;
-                    bool hasInfantry = false;
-                    bool hasHeavy = false;
-                    bool hasNazgul = false;
-                    for (const auto& e : enemies) {
-                        if (e.GetType() == EnemyType::ORC || e.GetType() == EnemyType::URUK) hasInfantry = true;
-                        if (e.GetType() == EnemyType::TROLL || e.GetType() == EnemyType::GROND || e.GetType() == EnemyType::COMMANDER) hasHeavy = true;
-                        if (e.GetType() == EnemyType::NAZGUL) hasNazgul = true;
+                if (!clickedExisting && isValidPlacement && world.BuildTower(snapPos, selectedTower)) Audio::PlaySFX(SoundId::BUILD_TOWER);
+            }
+            // Right click sells the tower under the mouse for half of what was put into it.
+            if (IsMouseButtonPressed(MOUSE_RIGHT_BUTTON)) {
+                for (int i = 0; i < (int)world.towers.size(); i++) {
+                    if (world.towers[i].IsClicked(mouseWorldPos)) {
+                        world.SellTower(i);
+                        Audio::PlaySFX(SoundId::BUILD_TOWER, 0.8f);
+                        break;
                     }
-                    if (hasInfantry) Audio::PlaySFX("orc_walk", 0.3f, 1.0f);
-                    if (hasHeavy) Audio::PlaySFX("heavy_walk", 0.2f, 0.8f);
-                    if (hasNazgul) Audio::PlaySFX("heavy_walk", 0.7f, 0.1f);
                 }
             }
 
-            bloodSystem.Update(dt);
-            for (int i = 0; i < enemies.size(); i++) {
-                enemies[i].Update(dt);
-                if (!enemies[i].IsAlive()) {
-                    gold += 15;
-                    urukBlood += enemies[i].GetManaReward() * 0.4f;
-                    if (urukBlood > MAX_BLOOD) urukBlood = MAX_BLOOD;
-                    Audio::PlaySFX("orc_death", 0.1f, GetRandomValue(80, 120) / 100.0f);
-                    Audio::PlaySFX("gold_gain", 0.1f, 1.0f + GetRandomValue(0, 2) / 10.0f);
-                    enemies.erase(enemies.begin() + i); i--; continue;
-                }
-                if (enemies[i].ReachedEnd()) {
-                    castleHealth -= enemies[i].GetDamage();
-                    enemies.erase(enemies.begin() + i); i--;
-                    if (castleHealth <= 0) {
-                        castleHealth = 0;
-                        Audio::StopMusic();
-                        Audio::PlayMusic("game_over");
-                        currentScreen = GameScreen::GAMEOVER;
-                    }
-                }
+            particles.Update(dt);
+            world.Update(dt);
+            history.Record(world, dt);
+            frameWorkMs = world.GetLastUpdateMs() + history.GetLastRecordMs();
+            if (world.bossSpawned) bossLabelTimer = 4.0f;
+            if (world.outcome == WorldOutcome::VICTORY) {
+                Audio::PlayMusic(MusicId::VICTORY_JINGLE, 0.5f);
+                currentScreen = GameScreen::VICTORY;
             }
-            for (int i = 0; i < (int)riders.size(); i++) {
-                riders[i].Update(dt);
-                for (Enemy& e : enemies) {
-                    if (e.IsAlive() && CheckCollisionCircles(riders[i].position, 30, e.GetPosition(), 20)) {
-                        float damageRate = 0.0f;
-                        if (e.GetType() == EnemyType::NAZGUL || e.GetType() == EnemyType::TROLL) damageRate = 0.008f;
-                        else damageRate = 0.02f;
-                        int damage = (int)(e.GetHealth() * damageRate);
-                        if (damage < 1) damage = 1;
-                        e.TakeDamage(damage);
-                        if (GetRandomValue(0, 4) == 0) bloodSystem.Spawn(e.GetPosition());
-                        if (!e.IsAlive()) {
-                            if (e.GetType() == EnemyType::NAZGUL || e.GetType() == EnemyType::TROLL) { gold += 50; urukBlood += 20; }
-                            else { gold += 3; urukBlood += (int)(e.GetManaReward() * 0.12f); }
-                            if (urukBlood > MAX_BLOOD) urukBlood = MAX_BLOOD;
-                        }
-                    }
-                }
-                if (!riders[i].active) { riders.erase(riders.begin() + i); i--; }
-            }
-            for (Tower& t : towers) t.Update(dt, enemies, projectiles);
-            for (int i = 0; i < projectiles.size(); i++) {
-                projectiles[i].Update(dt);
-                if (projectiles[i].active && projectiles[i].type != ProjectileType::MELEE) {
-                    for (Enemy& e : enemies) {
-                        if (e.IsAlive() && CheckCollisionCircles(projectiles[i].position, 5, e.GetPosition(), e.GetRadius())) {
-                            e.TakeDamage(projectiles[i].damage);
-                            bloodSystem.Spawn(e.GetPosition());
-                            if (projectiles[i].type == ProjectileType::ICE) Audio::PlaySFX("ice_hit", 0.3f, 1.0f);
-                            else Audio::PlaySFX("arrow_hit", 0.1f + GetRandomValue(0, 2) / 10.0f);
-                            if (projectiles[i].type == ProjectileType::ICE) e.ApplySlow(0.5f, 2.0f);
-                            projectiles[i].active = false;
-                            if (!e.IsAlive()) { gold += 15; urukBlood += e.GetManaReward(); if (urukBlood > MAX_BLOOD) urukBlood = MAX_BLOOD; }
-                            break;
-                        }
-                    }
-                }
-                if (!projectiles[i].active) { projectiles.erase(projectiles.begin() + i); i--; }
+            else if (world.outcome == WorldOutcome::DEFEAT) {
+                Audio::PlayMusic(MusicId::GAME_OVER, 0.5f);
+                currentScreen = GameScreen::GAMEOVER;
             }
 
-            BeginMode2D(camera);
+            Renderer::BeginMode2D(camera);
 
            
             if (currentLevel->background.id > 0) {
@@ -813,129 +600,148 @@ int main(void)
                
                 Rectangle destRec = { 0, 0, (float)currentLevel->mapWidth, (float)gameScreenHeight };
 
-                DrawTexturePro(currentLevel->background, sourceRec, destRec, { 0, 0 }, 0.0f, WHITE);
+                Renderer::DrawTexturePro(currentLevel->background, sourceRec, destRec, { 0, 0 }, 0.0f, WHITE);
             }
             else {
                 
-                DrawRectangle(0, 0, currentLevel->mapWidth, gameScreenHeight, currentLevel->bgColor);
+                Renderer::DrawRectangle(0, 0, currentLevel->mapWidth, gameScreenHeight, currentLevel->bgColor);
             }
 
+            const Texture2D& road = AssetRegistry::Get(texRoad);
             for (int y = 0; y < MAP_ROWS; y++) {
                 for (int x = 0; x < currentLevel->cols; x++) {
                     Rectangle destRect = { (float)x * TILE_SIZE, (float)y * TILE_SIZE, (float)TILE_SIZE, (float)TILE_SIZE };
                     if (currentLevel->tileMap[y][x] != 0) {
-                        if (texRoad.id > 0) DrawTexturePro(texRoad, { 0,0,(float)texRoad.width,(float)texRoad.height }, destRect, { 0,0 }, 0, WHITE);
-                        else DrawRectangleRec(destRect, BROWN);
+                        if (road.id > 0) Renderer::DrawTexturePro(road, { 0,0,(float)road.width,(float)road.height }, destRect, { 0,0 }, 0, WHITE);
+                        else Renderer::DrawRectangleRec(destRect, BROWN);
                     }
                 }
             }
-            if (texCity.id > 0) {
-                DrawTexturePro(texCity, { 0, 0, (float)texCity.width, (float)texCity.height }, { currentLevel->castlePos.x, currentLevel->castlePos.y, (float)texCity.width * currentLevel->castleScale, (float)texCity.height * currentLevel->castleScale }, { 0, 0 }, 0.0f, WHITE);
+            const Texture2D& city = AssetRegistry::Get(texCity);
+            if (city.id > 0) {
+                Renderer::DrawTexturePro(city, { 0, 0, (float)city.width, (float)city.height }, { currentLevel->castlePos.x, currentLevel->castlePos.y, (float)city.width * currentLevel->castleScale, (float)city.height * currentLevel->castleScale }, { 0, 0 }, 0.0f, WHITE);
             }
 
-            float healthPct = (float)castleHealth / CASTLE_MAX_HEALTH;
+            char castleLabel[32];
+            float healthPct = (float)world.castleHealth / CASTLE_MAX_HEALTH;
             float barX = currentLevel->castlePos.x + 20;
             float barY = currentLevel->castlePos.y - 20;
             float barW = 200.0f;
             float barH = 20.0f;
-            DrawRectangle(barX, barY, barW, barH, DARKGRAY);
+            Renderer::DrawRectangle(barX, barY, barW, barH, DARKGRAY);
             Color barColor = GREEN;
             if (healthPct < 0.5f) barColor = ORANGE;
             if (healthPct < 0.2f) barColor = RED;
-            DrawRectangle(barX, barY, barW * healthPct, barH, barColor);
-            DrawRectangleLines(barX, barY, barW, barH, BLACK);
-            DrawText(TextFormat("%d / %d", castleHealth, CASTLE_MAX_HEALTH), barX + 60, barY + 2, 20, WHITE);
+            Renderer::DrawRectangle(barX, barY, barW * healthPct, barH, barColor);
+            Renderer::DrawRectangleLines(barX, barY, barW, barH, BLACK);
+            TextCache::Draw(TextCache::Format(castleLabel, sizeof(castleLabel), "", world.castleHealth, " / ", CASTLE_MAX_HEALTH), barX + 60, barY + 2, 20, WHITE);
 
-            for (const auto& t : towers) t.Draw();
-            for (const auto& e : enemies) e.Draw();
-            for (auto& r : riders) r.Draw();
-            bloodSystem.Draw();
-            for (const auto& p : projectiles) p.Draw();
+            // Units, projectiles and the particle layers below and above them; see World::Draw.
+            world.Draw(renderList, { camera.target.x, camera.target.y, (float)gameScreenWidth, (float)gameScreenHeight });
 
             if (!isHoveringUI) {
-                Texture2D previewTex = texTowerArcher;
-                if (selectedTower == TowerType::MELEE) previewTex = texTowerMelee;
-                else if (selectedTower == TowerType::ICE) previewTex = texTowerIce;
+                TextureHandle previewHandle = texTowerArcher;
+                if (selectedTower == TowerType::MELEE) previewHandle = texTowerMelee;
+                else if (selectedTower == TowerType::ICE) previewHandle = texTowerIce;
+                else if (selectedTower == TowerType::BANNER || selectedTower == TowerType::CATAPULT || selectedTower == TowerType::LIGHTNING) previewHandle = TextureHandle();
+                const Texture2D& previewTex = AssetRegistry::Get(previewHandle);
                 Color ghostColor = isValidPlacement ? Fade(GREEN, 0.5f) : Fade(RED, 0.5f);
-                float range = GetTowerRange(selectedTower);
-                DrawCircleV(snapPos, range, Fade(ghostColor, 0.2f));
-                DrawCircleLines((int)snapPos.x, (int)snapPos.y, range, ghostColor);
+                float range = Tower::GetBaseRange(selectedTower);
+                Renderer::DrawCircleV(snapPos, range, Fade(ghostColor, 0.2f));
+                Renderer::DrawCircleLines((int)snapPos.x, (int)snapPos.y, range, ghostColor);
                 if (previewTex.id > 0) {
                     Rectangle src = { 0, 0, (float)previewTex.width, (float)previewTex.height };
                     Rectangle dest = { snapPos.x, snapPos.y, 64, 114 };
                     Vector2 origin = { 32, 100 };
-                    DrawTexturePro(previewTex, src, dest, origin, 0.0f, ghostColor);
+                    Renderer::DrawTexturePro(previewTex, src, dest, origin, 0.0f, ghostColor);
                 }
             }
             bool hoverExisting = false;
-            for (const Tower& t : towers) {
+            char upgradeLabel[32];
+            for (const Tower& t : world.towers) {
                 if (t.IsClicked(mouseWorldPos)) {
                     hoverExisting = true;
-                    DrawText(TextFormat("UPGRADE: %dg", t.GetUpgradeCost()), (int)mouseWorldPos.x, (int)mouseWorldPos.y - 40, 20, GREEN);
-                    DrawCircleLines((int)t.GetPosition().x, (int)t.GetPosition().y, t.GetRange(), GREEN);
+                    if (t.CanUpgrade()) TextCache::Draw(TextCache::Format(upgradeLabel, sizeof(upgradeLabel), "UPGRADE: ", t.GetUpgradeCost(), "g"), (int)mouseWorldPos.x, (int)mouseWorldPos.y - 40, 20, GREEN);
+                    else TextCache::Draw("MAX LEVEL", (int)mouseWorldPos.x, (int)mouseWorldPos.y - 40, 20, GRAY);
+                    TextCache::Draw(TextCache::Format(upgradeLabel, sizeof(upgradeLabel), "SELL: ", t.GetSpent() / 2, "g"), (int)mouseWorldPos.x, (int)mouseWorldPos.y - 62, 20, GOLD);
+                    // A banner shows the reach of its aura instead of a range.
+                    Renderer::DrawCircleLines((int)t.GetPosition().x, (int)t.GetPosition().y, t.GetRange(), t.IsSupport() ? GOLD : GREEN);
                 }
             }
             if (!hoverExisting && !isHoveringUI) {
-                float range = GetTowerRange(selectedTower);
+                float range = Tower::GetBaseRange(selectedTower);
                 Color c = isValidPlacement ? Fade(GREEN, 0.5f) : Fade(RED, 0.5f);
                 Color border = isValidPlacement ? GREEN : RED;
-                DrawCircleV(snapPos, range, c);
-                DrawCircleLines((int)snapPos.x, (int)snapPos.y, range, border);
+                Renderer::DrawCircleV(snapPos, range, c);
+                Renderer::DrawCircleLines((int)snapPos.x, (int)snapPos.y, range, border);
             }
-            EndMode2D();
+            Renderer::EndMode2D();
 
             if (bossLabelTimer > 0.0f) {
                 bossLabelTimer -= dt;
                 float alpha = (sinf(GetTime() * 10.0f) + 1.0f) / 2.0f;
                 const char* text = "WITCH KING IS HERE";
                 int fontSize = 60;
-                int textW = MeasureText(text, fontSize);
+                int textW = TextCache::Measure(text, fontSize);
                 int textX = (gameScreenWidth - textW) / 2;
                 int textY = 200;
-                DrawText(text, textX + 4, textY + 4, fontSize, Fade(BLACK, 0.7f));
-                DrawText(text, textX, textY, fontSize, Fade(RED, 0.8f + (alpha * 0.2f)));
+                TextCache::Draw(text, textX + 4, textY + 4, fontSize, Fade(BLACK, 0.7f));
+                TextCache::Draw(text, textX, textY, fontSize, Fade(RED, 0.8f + (alpha * 0.2f)));
             }
             if (flashTimer > 0.0f) {
                 flashTimer -= dt;
-                DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, Fade(WHITE, flashTimer * 0.2f));
+                Renderer::DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, Fade(WHITE, flashTimer * 0.2f));
                 float cellSize = 64.0f;
                 int animFrame = (int)((2.0f - flashTimer) * 4.0f) % 7;
                 Rectangle source = { animFrame * cellSize, 2 * cellSize, cellSize, cellSize };
-                DrawTexturePro(texGandalf, source, { (float)gameScreenWidth / 2 - 64, (float)gameScreenHeight / 2 - 80, 128, 128 }, { 0,0 }, 0.0f, Fade(WHITE, flashTimer + 0.2f));
-            }
-
-            DrawRectangle(0, gameScreenHeight - 60, gameScreenWidth, 60, Fade(BLACK, 0.9f));
-            DrawText(TextFormat("Gold: %d", gold), 20, gameScreenHeight - 45, 20, YELLOW);
-            DrawText(TextFormat("Wave: %d / %d", currentWaveIndex + 1, currentLevel->waves.size()), 20, gameScreenHeight - 25, 20, WHITE);
-            Color c1 = (selectedTower == TowerType::ARCHER) ? YELLOW : GRAY;
-            Color c2 = (selectedTower == TowerType::MELEE) ? RED : GRAY;
-            Color c3 = (selectedTower == TowerType::ICE) ? SKYBLUE : GRAY;
-            DrawText("[1] Archer", 400, gameScreenHeight - 40, 20, c1);
-            DrawText("[2] Melee", 550, gameScreenHeight - 40, 20, c2);
-            DrawText("[3] Ice", 700, gameScreenHeight - 40, 20, c3);
-            int rightX = gameScreenWidth - 450; int uiBarY = gameScreenHeight - 35;
-            DrawRectangleLines(rightX, uiBarY, 120, 15, GRAY);
-            float bloodPct = (float)urukBlood / MAX_BLOOD;
-            DrawRectangle(rightX + 1, uiBarY + 1, (int)(118 * bloodPct), 13, MAROON);
-            DrawText("BLOOD", rightX + 40, uiBarY + 3, 10, WHITE);
-            Color cQ = (urukBlood >= COST_GANDALF) ? WHITE : DARKGRAY;
-            Color cW = (urukBlood >= COST_ROHIRRIM) ? WHITE : DARKGRAY;
-            DrawText("[Q] GANDALF", rightX + 130, uiBarY - 5, 20, cQ);
-            DrawText("[W] ROHIRRIM", rightX + 280, uiBarY - 5, 20, cW);
-
-           
-            if (GuiButton({ (float)gameScreenWidth - 120, 10, 100, 30 }, "MENU", texBtnNormal, texBtnHover, mouseScreenPos)) {
+                Renderer::DrawTexturePro(AssetRegistry::Get(texGandalf), source, { (float)gameScreenWidth / 2 - 64, (float)gameScreenHeight / 2 - 80, 128, 128 }, { 0,0 }, 0.0f, Fade(WHITE, flashTimer + 0.2f));
+            }
+
+            /* HUD :
+             The MENU button is hit-tested here; everything visible goes through the retained HUD,
+             which only redraws its texture when one of these values differs from last frame.*/
+            bool menuHover = CheckCollisionPointRec(mouseScreenPos, hud.GetMenuButtonRect());
+            hud.SetGold(world.gold);
+            hud.SetWave(world.currentWaveIndex, currentLevel->endless ? 0 : (int)currentLevel->waves.size());
+            hud.SetSelectedTower(selectedTower);
+            hud.SetUrukBlood(world.urukBlood);
+            hud.SetMenuButtonState(menuHover, menuHover && IsMouseButtonDown(MOUSE_LEFT_BUTTON));
+            hud.Draw(target);
+
+            if (showPerf) {
+                // The render figure is last frame's whole CPU-side frame minus the simulation and recording inside it.
+                perfSimMs += world.GetLastUpdateMs();
+                perfRenderMs += Renderer::GetStats().cpuMs - lastFrameWorkMs;
+                perfFrames++;
+                perfTimer += dt;
+                if (perfTimer >= 0.5f) {
+                    perfSimUs = (int)(perfSimMs * 1000.0 / perfFrames);
+                    perfRenderUs = (int)(perfRenderMs * 1000.0 / perfFrames);
+                    perfTimer = 0.0f; perfFrames = 0; perfSimMs = 0.0; perfRenderMs = 0.0;
+                }
+                char perfLine[64];
+                Renderer::DrawRectangle(10, 10, 230, 182, Fade(BLACK, 0.6f));
+                TextCache::Draw(TextCache::Format(perfLine, sizeof(perfLine), "SIM ", perfSimUs, " us"), 20, 20, 20, GREEN);
+                TextCache::Draw(TextCache::Format(perfLine, sizeof(perfLine), "RENDER ", perfRenderUs, " us"), 20, 42, 20, GREEN);
+                TextCache::Draw(TextCache::Format(perfLine, sizeof(perfLine), "ENEMIES ", (int)world.enemies.size()), 20, 64, 20, RAYWHITE);
+                TextCache::Draw(TextCache::Format(perfLine, sizeof(perfLine), "PROJECTILES ", (int)world.projectiles.size()), 20, 86, 20, RAYWHITE);
+                TextCache::Draw(TextCache::Format(perfLine, sizeof(perfLine), "TOWERS ", (int)world.towers.size()), 20, 108, 20, RAYWHITE);
+                TextCache::Draw(TextCache::Format(perfLine, sizeof(perfLine), "LEAKED ", world.totalLeaked), 20, 130, 20, RAYWHITE);
+                TextCache::Draw(TextCache::Format(perfLine, sizeof(perfLine), "HISTORY ", (int)(history.GetBytesPerMinute() / 1024.0f), " KB/min"), 20, 152, 20, RAYWHITE);
+            }
+
+            if (menuHover && IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
+                Audio::PlaySFX(SoundId::UI_CLICK);
                 currentScreen = GameScreen::TITLE;
             }
         }
         break;
 
         case GameScreen::VICTORY:
-            if (texVictoryBg.id > 0) DrawTexturePro(texVictoryBg, { 0, 0, (float)texVictoryBg.width, (float)texVictoryBg.height }, { 0, 0, (float)gameScreenWidth, (float)gameScreenHeight }, { 0, 0 }, 0.0f, WHITE);
-            else DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, BLACK);
-            DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, Fade(BLACK, 0.4f));
-            DrawText("VICTORY!", gameScreenWidth / 2 - MeasureText("VICTORY!", 80) / 2, gameScreenHeight / 2 - 100, 80, GOLD);
-            DrawText("Gondor is Safe... For now.", gameScreenWidth / 2 - MeasureText("Gondor is Safe... For now.", 30) / 2, gameScreenHeight / 2, 30, WHITE);
+            if (!DrawScreenTexture(texVictoryBg, gameScreenWidth, gameScreenHeight, WHITE)) Renderer::DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, BLACK);
+            Renderer::DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, Fade(BLACK, 0.4f));
+            TextCache::Draw("VICTORY!", gameScreenWidth / 2 - TextCache::Measure("VICTORY!", 80) / 2, gameScreenHeight / 2 - 100, 80, GOLD);
+            TextCache::Draw("Gondor is Safe... For now.", gameScreenWidth / 2 - TextCache::Measure("Gondor is Safe... For now.", 30) / 2, gameScreenHeight / 2, 30, WHITE);
             // [FIX] mouseScreenPos parametresini ekledik
             if (GuiButton({ (float)gameScreenWidth / 2 - 100, (float)gameScreenHeight / 2 + 80, 200, 50 }, "MAIN MENU", texBtnNormal, texBtnHover, mouseScreenPos)) {
                 Audio::StopMusic();
@@ -944,12 +750,11 @@ int main(void)
             break;
 
         case GameScreen::GAMEOVER:
-            if (texDefeatBg.id > 0) DrawTexturePro(texDefeatBg, { 0, 0, (float)texDefeatBg.width, (float)texDefeatBg.height }, { 0, 0, (float)gameScreenWidth, (float)gameScreenHeight }, { 0, 0 }, 0.0f, WHITE);
-            else DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, BLACK);
-            DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, Fade(BLACK, 0.6f));
-            DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, Fade(RED, 0.2f));
-            DrawText("DEFEAT", gameScreenWidth / 2 - MeasureText("DEFEAT", 80) / 2, gameScreenHeight / 2 - 100, 80, RED);
-            DrawText("The White City has Fallen.", gameScreenWidth / 2 - MeasureText("The White City has Fallen.", 30) / 2, gameScreenHeight / 2, 30, RAYWHITE);
+            if (!DrawScreenTexture(texDefeatBg, gameScreenWidth, gameScreenHeight, WHITE)) Renderer::DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, BLACK);
+            Renderer::DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, Fade(BLACK, 0.6f));
+            Renderer::DrawRectangle(0, 0, gameScreenWidth, gameScreenHeight, Fade(RED, 0.2f));
+            TextCache::Draw("DEFEAT", gameScreenWidth / 2 - TextCache::Measure("DEFEAT", 80) / 2, gameScreenHeight / 2 - 100, 80, RED);
+            TextCache::Draw("The White City has Fallen.", gameScreenWidth / 2 - TextCache::Measure("The White City has Fallen.", 30) / 2, gameScreenHeight / 2, 30, RAYWHITE);
             
             if (GuiButton({ (float)gameScreenWidth / 2 - 100, (float)gameScreenHeight / 2 + 80, 200, 50 }, "MAIN MENU", texBtnNormal, texBtnHover, mouseScreenPos)) {
                 Audio::StopMusic();
@@ -958,31 +763,42 @@ int main(void)
             break;
         }
 
-        EndTextureMode(); 
+        // This frame's sound requests go to the audio thread now, not one frame later.
+        Audio::Update();
+
+        Renderer::EndTextureMode(); 
         BeginDrawing();
-        ClearBackground(BLACK);
+        Renderer::ClearBackground(BLACK);
 
         Rectangle sourceRec = { 0.0f, 0.0f, (float)target.texture.width, -(float)target.texture.height };
         Rectangle destRec = { (GetScreenWidth() - (gameScreenWidth * scale)) * 0.5f, (GetScreenHeight() - (gameScreenHeight * scale)) * 0.5f, gameScreenWidth * scale, gameScreenHeight * scale };
-        DrawTexturePro(target.texture, sourceRec, destRec, { 0, 0 }, 0.0f, WHITE);
+        Renderer::DrawTexturePro(target.texture, sourceRec, destRec, { 0, 0 }, 0.0f, WHITE);
 
+        Renderer::EndFrame();
         EndDrawing();
+        AssetRegistry::Update();
+
+        // Time-to-first-interactive-frame: from window creation until the first menu frame is on screen.
+        if (!firstFrameReported) {
+            TraceLog(LOG_INFO, "STARTUP: first interactive frame after %.0f ms", GetTime() * 1000.0);
+            firstFrameReported = true;
+        }
     } 
 
    
-    UnloadTexture(texOrc); UnloadTexture(texUruk); UnloadTexture(texTroll); UnloadTexture(texGrond); UnloadTexture(texCommander);
-    UnloadTexture(texTowerArcher); UnloadTexture(texTowerMelee); UnloadTexture(texTowerIce);
-    UnloadTexture(texMenuBg); UnloadTexture(texBtnNormal); UnloadTexture(texBtnHover);
-    UnloadTexture(texProjArrow); UnloadTexture(texProjIce); UnloadTexture(texProjMelee);
-    UnloadTexture(texBlood); UnloadTexture(texRoad); UnloadTexture(texCity);
-    UnloadTexture(texGandalf);
-    UnloadTexture(texVictoryBg);
-    UnloadTexture(texDefeatBg);
+    // Entities and pinned refs go first, so the registry sees every reference released before it unloads.
+    world.Reset(nullptr, 0);
+    rohirrimFrames.clear();
+    texBtnNormalRef = TextureRef(); texBtnHoverRef = TextureRef(); texBloodRef = TextureRef();
+    AssetRegistry::LogReport();
+    AssetRegistry::Clear();
+    AudioStats audioStats = Audio::GetStats();
+    TraceLog(LOG_INFO, "AUDIO: %d requests, %d coalesced, %d culled by distance, %d over frame budget, %d started, %d stolen, %d restarted at cap, %d dropped",
+        audioStats.requests, audioStats.coalesced, audioStats.culled, audioStats.overBudget, audioStats.started, audioStats.stolen, audioStats.restarted, audioStats.dropped);
     UnloadRenderTexture(target);
-    for (auto& lvl : allLevels) {
-        UnloadTexture(lvl.background);
-        for (auto* p : lvl.paths) delete p;
-    }
+    hud.Unload();
+    levelResources.Release();
+    DestroyLevels(allLevels);
 
     Audio::Close();
     CloseWindow();
@@ -0,0 +1,55 @@
+﻿/* ASSET PACKER :
+ Builds the assets.pak archive read by the game (see include/AssetArchive.h) from the assets/ tree.
+ Archive paths keep the "assets/..." prefix, so they match the paths used in main.cpp.
+
+ Build (C++17 for std::filesystem), from the repository root:
+   g++ -std=c++17 -O2 -Iinclude tools/pack_assets.cpp src/AssetArchive.cpp -o pack_assets
+   cl /std:c++17 /O2 /Iinclude tools\pack_assets.cpp src\AssetArchive.cpp
+ Usage:
+   pack_assets [assets directory] [output file]      defaults: assets  assets.pak */
+#include "AssetArchive.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+int main(int argc, char** argv) {
+    namespace fs = std::filesystem;
+    fs::path root = (argc > 1) ? argv[1] : "assets";
+    const char* outPath = (argc > 2) ? argv[2] : "assets.pak";
+
+    if (!fs::is_directory(root)) {
+        fprintf(stderr, "pack: %s is not a directory\n", root.string().c_str());
+        return 1;
+    }
+
+    std::vector<std::string> archivePaths;
+    std::vector<std::string> diskPaths;
+    // "assets/", "./assets" and "." (from inside assets/) all name the same folder; take its name from the
+    // normalized absolute path, where a trailing separator leaves an empty filename to strip.
+    fs::path full = fs::absolute(root).lexically_normal();
+    if (!full.has_filename()) full = full.parent_path();
+    fs::path prefix = full.filename();
+    if (prefix.empty()) {
+        fprintf(stderr, "pack: cannot derive an archive prefix from %s\n", root.string().c_str());
+        return 1;
+    }
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file()) continue;
+        std::string name = entry.path().filename().string();
+        if (name == ".DS_Store" || entry.path().extension() == ".zip") continue;
+
+        std::string archivePath = (prefix / fs::relative(entry.path(), root)).generic_string();
+        archivePaths.push_back(archivePath);
+        diskPaths.push_back(entry.path().string());
+    }
+
+    if (!AssetArchive::Write(outPath, archivePaths, diskPaths)) {
+        fprintf(stderr, "pack: failed to write %s\n", outPath);
+        return 1;
+    }
+
+    unsigned long long total = 0;
+    for (const std::string& p : diskPaths) total += fs::file_size(p);
+    printf("pack: %d files, %.1f MB -> %s\n", (int)archivePaths.size(), total / (1024.0 * 1024.0), outPath);
+    return 0;
+}